@@ -0,0 +1,104 @@
+#include <comp421/hardware.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tty_buffer.h"
+// a host microbenchmark of the tty receive path: the old one received into a malloc'ed line and copied it
+// into the ring, the new one receives straight into the ring and stages only when the free space wraps around
+// usage: bench_receive [line length] [lines]
+
+// TTY_RECEIVE_RING_SIZE in terminal.h
+#define RING_SIZE 4096
+
+static char pattern[TERMINAL_MAX_LINE];
+static int line_len;
+
+// the stand-in terminal always has one line of line_len chars ready
+int TtyReceive(int tty_id, void *buf, int len)
+{
+    (void)tty_id;
+    int n = line_len < len ? line_len : len;
+    memcpy(buf, pattern, n);
+    return n;
+}
+
+void TracePrintf(int level, char *fmt, ...)
+{
+    (void)level;
+    (void)fmt;
+}
+
+static char staging[TERMINAL_MAX_LINE];
+static int staged;
+
+static void receiveMalloc(tty_buf *ring)
+{
+    void *buf = malloc(TERMINAL_MAX_LINE);
+    int len = TtyReceive(0, buf, TERMINAL_MAX_LINE);
+    addBuf(ring, buf, len);
+    free(buf);
+}
+
+static void receiveDirect(tty_buf *ring)
+{
+    void *space = reserveBuf(ring, TERMINAL_MAX_LINE);
+    if (space != NULL)
+    {
+        commitBuf(ring, TtyReceive(0, space, TERMINAL_MAX_LINE));
+        return;
+    }
+    int len = TtyReceive(0, staging, TERMINAL_MAX_LINE);
+    addBuf(ring, staging, len);
+    staged++;
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// receive the lines while a reader stays two lines behind, so the ring never empties and keeps wrapping around
+static double run(void (*receive)(tty_buf *), int lines)
+{
+    tty_buf *ring = createBuffer(RING_SIZE, 1);
+    static char out[TERMINAL_MAX_LINE];
+    int i;
+    double start = now();
+    for (i = 0; i < lines; i++)
+    {
+        receive(ring);
+        if (i >= 2)
+            getBuf(ring, out, TERMINAL_MAX_LINE, 1);
+    }
+    double elapsed = now() - start;
+    freeBuffer(ring);
+    return elapsed / lines;
+}
+
+int main(int argc, char **argv)
+{
+    line_len = argc > 1 ? atoi(argv[1]) : 80;
+    int lines = argc > 2 ? atoi(argv[2]) : 1000000;
+    if (line_len < 1 || line_len > TERMINAL_MAX_LINE || lines < 2)
+    {
+        fprintf(stderr, "usage: %s [line length 1..%d] [lines]\n", argv[0], TERMINAL_MAX_LINE);
+        return 1;
+    }
+    memset(pattern, 'x', line_len - 1);
+    pattern[line_len - 1] = '\n';
+
+    // once each to warm up the allocator and the caches
+    run(receiveMalloc, lines / 10 + 2);
+    run(receiveDirect, lines / 10 + 2);
+    staged = 0;
+
+    double malloc_ns = run(receiveMalloc, lines);
+    double direct_ns = run(receiveDirect, lines);
+    printf("%d lines of %d chars\n", lines, line_len);
+    printf("malloc + copy: %8.1f ns/line\n", malloc_ns);
+    printf("direct:        %8.1f ns/line (%d lines staged)\n", direct_ns, staged);
+    return 0;
+}
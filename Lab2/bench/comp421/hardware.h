@@ -0,0 +1,12 @@
+#ifndef BENCH_COMP421_HARDWARE_H
+#define BENCH_COMP421_HARDWARE_H
+// a host stand-in for the few parts of the hardware interface the tty buffer code uses
+// only for the benchmarks in this directory, the kernel is built against the real header
+
+#define TERMINAL_MAX_LINE 1024
+
+int TtyReceive(int tty_id, void *buf, int len);
+
+void TracePrintf(int level, char *fmt, ...);
+
+#endif // BENCH_COMP421_HARDWARE_H
@@ -0,0 +1,5 @@
+#ifndef BENCH_COMP421_YALNIX_H
+#define BENCH_COMP421_YALNIX_H
+// a host stand-in for yalnix.h, the tty buffer code needs nothing from it
+
+#endif // BENCH_COMP421_YALNIX_H
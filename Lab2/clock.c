@@ -0,0 +1,14 @@
+#include "clock.h"
+
+// the number of clock interrupts since boot, never reset
+static int tick_count = 0;
+
+int tickClock()
+{
+  return ++tick_count;
+}
+
+int getTickCount()
+{
+  return tick_count;
+}
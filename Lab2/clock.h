@@ -0,0 +1,12 @@
+#ifndef YALNIX_CLOCK_H
+#define YALNIX_CLOCK_H
+// this file keeps the number of clock interrupts since boot, the only time the kernel has
+// so every time it measures is in whole clock ticks
+
+// count one more clock interrupt, return the new tick count
+int tickClock();
+
+// get the number of clock ticks since boot
+int getTickCount();
+
+#endif // YALNIX_CLOCK_H
@@ -0,0 +1,137 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcb.h"
+#include "container.h"
+
+static struct container containers[MAX_CONTAINERS];
+// 1 if the container slot is in use
+static int container_used[MAX_CONTAINERS];
+
+void initContainers()
+{
+  memset(containers, 0, sizeof(containers));
+  memset(container_used, 0, sizeof(container_used));
+  container_used[ROOT_CONTAINER] = 1;
+}
+
+struct container *createContainer(int frame_limit, int cpu_limit)
+{
+  if (frame_limit < 0 || cpu_limit < 0 || cpu_limit > CONTAINER_CPU_PERIOD)
+  {
+    TracePrintf(0, "createContainer: invalid frame limit %d or cpu limit %d\n", frame_limit, cpu_limit);
+    return NULL;
+  }
+
+  int i;
+  for (i = 0; i < MAX_CONTAINERS; i++)
+  {
+    if (!container_used[i])
+    {
+      container_used[i] = 1;
+      memset(&containers[i], 0, sizeof(struct container));
+      containers[i].id = i;
+      containers[i].frame_limit = frame_limit;
+      containers[i].cpu_limit = cpu_limit;
+      TracePrintf(2, "createContainer: container %d with frame limit %d and cpu limit %d/%d\n", i, frame_limit, cpu_limit, CONTAINER_CPU_PERIOD);
+      return &containers[i];
+    }
+  }
+
+  TracePrintf(0, "createContainer: out of containers\n");
+  return NULL;
+}
+
+struct container *getContainer(int id)
+{
+  if (id < 0 || id >= MAX_CONTAINERS || !container_used[id])
+    return NULL;
+  return &containers[id];
+}
+
+// a container is gone once it has no process and no frame left
+static void releaseContainer(struct container *container)
+{
+  if (container->id != ROOT_CONTAINER && container->process_count == 0 && container->frames == 0)
+  {
+    TracePrintf(2, "releaseContainer: container %d is released\n", container->id);
+    container_used[container->id] = 0;
+  }
+}
+
+void joinContainer(struct pcb *pcb, struct container *container)
+{
+  leaveContainer(pcb);
+  pcb->container = container;
+  container->process_count++;
+}
+
+void leaveContainer(struct pcb *pcb)
+{
+  struct container *container = pcb->container;
+  if (container == NULL)
+    return;
+  pcb->container = NULL;
+  container->process_count--;
+  releaseContainer(container);
+}
+
+int canChargeFrames(struct container *container, int count)
+{
+  if (container == NULL || container->frame_limit == 0)
+    return 1;
+  return container->frames + count <= container->frame_limit;
+}
+
+void chargeFrame(struct container *container)
+{
+  if (container != NULL)
+    container->frames++;
+}
+
+void unchargeFrame(struct container *container)
+{
+  if (container == NULL)
+    return;
+  container->frames--;
+  releaseContainer(container);
+}
+
+// start a new cpu period for the container if the old one is over
+static void refreshCpuPeriod(struct container *container, int tick)
+{
+  int period = tick / CONTAINER_CPU_PERIOD;
+  if (container->cpu_period != period)
+  {
+    container->cpu_period = period;
+    container->cpu_used = 0;
+  }
+}
+
+int chargeCpuTick(struct container *container, int tick)
+{
+  if (container == NULL)
+    return 0;
+  refreshCpuPeriod(container, tick);
+  container->cpu_used++;
+  container->cpu_total++;
+  // a tick may still be charged after the limit is hit (the process could not be switched out at once)
+  // so every tick past the limit asks for a switch again, but the period is counted as throttled once
+  if (container->cpu_limit > 0 && container->cpu_used >= container->cpu_limit)
+  {
+    if (container->cpu_used == container->cpu_limit)
+      container->throttled++;
+    TracePrintf(3, "chargeCpuTick: container %d used up its %d ticks of period %d\n", container->id, container->cpu_limit, container->cpu_period);
+    return 1;
+  }
+  return 0;
+}
+
+int isContainerThrottled(struct container *container, int tick)
+{
+  if (container == NULL || container->cpu_limit == 0)
+    return 0;
+  refreshCpuPeriod(container, tick);
+  return container->cpu_used >= container->cpu_limit;
+}
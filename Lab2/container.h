@@ -0,0 +1,58 @@
+#ifndef YALNIX_CONTAINER_H
+#define YALNIX_CONTAINER_H
+// this file manages the resource containers
+// a container caps the physical frames and the cpu ticks of the processes in it
+// every process belongs to one container and its children inherit it across Fork
+
+struct pcb;
+
+// the number of containers, including the root container
+#define MAX_CONTAINERS 16
+// the root container has no limits, the init process starts in it
+#define ROOT_CONTAINER 0
+// the cpu limit of a container is counted in clock ticks per CONTAINER_CPU_PERIOD ticks
+#define CONTAINER_CPU_PERIOD 20
+
+typedef struct container
+{
+  int id;
+  int process_count; // the number of processes in the container
+  int frame_limit;   // the most physical frames the container may hold, 0 means no limit
+  int frames;        // the physical frames charged to the container now
+  int cpu_limit;     // the most clock ticks the container may run in a period, 0 means no limit
+  int cpu_used;      // the clock ticks used in the current period
+  int cpu_period;    // the period cpu_used belongs to
+  int cpu_total;     // the clock ticks used since the container was created
+  int throttled;     // the number of periods the container has hit its cpu limit
+} container;
+
+// initialize the containers, the root container is ready after this
+void initContainers();
+
+// create a new container, return NULL if there is no room or the limits are invalid
+struct container *createContainer(int frame_limit, int cpu_limit);
+
+// get the container by id, return NULL if it does not exist
+struct container *getContainer(int id);
+
+// the process joins the container and leaves its old one
+void joinContainer(struct pcb *pcb, struct container *container);
+
+// the process leaves its container, used when the process exits
+void leaveContainer(struct pcb *pcb);
+
+// check if the container can be charged count more frames
+int canChargeFrames(struct container *container, int count);
+
+// charge and uncharge frames to the container, a NULL container is never charged
+void chargeFrame(struct container *container);
+void unchargeFrame(struct container *container);
+
+// charge a clock tick to the container
+// return 1 if the container has used up its cpu limit of the current period
+int chargeCpuTick(struct container *container, int tick);
+
+// check if the processes of the container have to wait for the next period to run
+int isContainerThrottled(struct container *container, int tick);
+
+#endif // YALNIX_CONTAINER_H
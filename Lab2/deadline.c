@@ -0,0 +1,133 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <limits.h>
+#include <stdlib.h>
+#include "deadline.h"
+#include "pcb.h"
+
+// all the processes in the deadline class, runnable or not
+static struct pcb *deadline_processes[MAX_DEADLINE_PROCESSES];
+static int deadline_process_count = 0;
+
+// the sum of budget / period of all the deadline processes
+static int total_utilization = 0;
+
+// the utilization of a process, rounded up so we never admit more than we can serve
+static int utilization(int period, int budget)
+{
+  return (budget * UTILIZATION_SCALE + period - 1) / period;
+}
+
+int setDeadline(struct pcb *pcb, int period, int budget, int tick)
+{
+  if (period < 0 || (period > 0 && (budget <= 0 || budget > period)))
+  {
+    TracePrintf(0, "setDeadline: invalid period %d and budget %d\n", period, budget);
+    return -1;
+  }
+
+  int old_utilization = pcb->rt_period > 0 ? utilization(pcb->rt_period, pcb->rt_budget) : 0;
+  int new_utilization = period > 0 ? utilization(period, budget) : 0;
+
+  // admission control
+  if (total_utilization - old_utilization + new_utilization > UTILIZATION_SCALE)
+  {
+    TracePrintf(0, "setDeadline: utilization would be %d/%d, rejecting process %d\n", total_utilization - old_utilization + new_utilization, UTILIZATION_SCALE, pcb->pid);
+    return -1;
+  }
+  if (pcb->rt_period == 0 && period > 0 && deadline_process_count == MAX_DEADLINE_PROCESSES)
+  {
+    TracePrintf(0, "setDeadline: too many deadline processes\n");
+    return -1;
+  }
+
+  if (period == 0)
+  {
+    clearDeadline(pcb);
+    return 0;
+  }
+
+  if (pcb->rt_period == 0)
+    deadline_processes[deadline_process_count++] = pcb;
+  total_utilization += new_utilization - old_utilization;
+
+  pcb->rt_period = period;
+  pcb->rt_budget = budget;
+  pcb->rt_deadline = tick + period;
+  pcb->rt_used = 0;
+  TracePrintf(2, "setDeadline: process %d has period %d and budget %d, utilization is now %d/%d\n", pcb->pid, period, budget, total_utilization, UTILIZATION_SCALE);
+  return 0;
+}
+
+void clearDeadline(struct pcb *pcb)
+{
+  if (pcb->rt_period == 0)
+    return;
+
+  TracePrintf(1, "clearDeadline: process %d missed %d out of %d deadlines\n", pcb->pid, pcb->rt_misses, pcb->rt_periods);
+
+  int i;
+  for (i = 0; i < deadline_process_count; i++)
+  {
+    if (deadline_processes[i] == pcb)
+    {
+      deadline_processes[i] = deadline_processes[--deadline_process_count];
+      break;
+    }
+  }
+  total_utilization -= utilization(pcb->rt_period, pcb->rt_budget);
+  pcb->rt_period = 0;
+  pcb->rt_budget = 0;
+}
+
+int chargeDeadlineTick(struct pcb *pcb)
+{
+  pcb->rt_used++;
+  return pcb->rt_used >= pcb->rt_budget;
+}
+
+void rollDeadlines(int tick)
+{
+  int i;
+  for (i = 0; i < deadline_process_count; i++)
+  {
+    struct pcb *pcb = deadline_processes[i];
+    if (pcb->rt_deadline > tick)
+      continue;
+
+    int runnable = pcb->status == RT_LIST || pcb->status == EXECUTION_LIST;
+    int used = pcb->rt_used;
+    while (pcb->rt_deadline <= tick)
+    {
+      // the job is still not done (the process has not blocked) by the end of its period
+      // though a job that got its whole budget has overrun it, the deadline was not missed for lack of cpu
+      if (runnable && used < pcb->rt_budget)
+      {
+        pcb->rt_misses++;
+        TracePrintf(1, "rollDeadlines: process %d missed its deadline at tick %d, %d misses so far\n", pcb->pid, pcb->rt_deadline, pcb->rt_misses);
+      }
+      pcb->rt_deadline += pcb->rt_period;
+      pcb->rt_periods++;
+      // the periods skipped over got no cpu at all
+      used = 0;
+    }
+    pcb->rt_used = 0;
+
+    if (runnable)
+    {
+      // re-add it so it is sorted by the new deadline, a throttled process also goes back to RT_LIST
+      removeProcessFromList(pcb);
+      addProcessToList(pcb, EXECUTION_LIST);
+    }
+  }
+}
+
+int getNextDeadlineTick()
+{
+  int next_tick = INT_MAX;
+  int i;
+  for (i = 0; i < deadline_process_count; i++)
+    if (deadline_processes[i]->rt_deadline < next_tick)
+      next_tick = deadline_processes[i]->rt_deadline;
+  return next_tick;
+}
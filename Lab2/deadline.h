@@ -0,0 +1,32 @@
+#ifndef YALNIX_DEADLINE_H
+#define YALNIX_DEADLINE_H
+#include "pcb.h"
+// this file manages the earliest-deadline-first scheduling class
+// a deadline process may run budget ticks in every period ticks, and the runnable ones
+// are kept in RT_LIST sorted by the end of their current period (see addProcessToList)
+
+// the most processes that can be in the deadline class at the same time
+#define MAX_DEADLINE_PROCESSES 16
+
+// utilization is counted in parts per UTILIZATION_SCALE, so we can stay in integers
+#define UTILIZATION_SCALE 1000
+
+// put the process into the deadline class, or take it out if period is 0
+// return -1 if the arguments are invalid or the total utilization would go above 1
+int setDeadline(struct pcb *pcb, int period, int budget, int tick);
+
+// take the process out of the deadline class, used when the process exits
+void clearDeadline(struct pcb *pcb);
+
+// charge a clock tick to the running deadline process
+// return 1 if it has used up the budget of its current period
+int chargeDeadlineTick(struct pcb *pcb);
+
+// start the next period of every deadline process whose period ends by the tick
+// counting a miss for those that are still runnable without having got their whole budget
+void rollDeadlines(int tick);
+
+// get the earliest tick that a period ends at, INT_MAX if there is no deadline process
+int getNextDeadlineTick();
+
+#endif // YALNIX_DEADLINE_H
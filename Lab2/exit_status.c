@@ -19,13 +19,15 @@ void initExitStatusList()
   exit_status_tail->pid = -1;
 }
 
-void addExitStatus(int pid, int ppid, int status)
+void addExitStatus(int pid, int ppid, int thread, int status, struct process_usage *usage)
 {
   struct ExitStatus *new_exit_status = malloc(sizeof(struct ExitStatus));
   memset(new_exit_status, 0, sizeof(struct ExitStatus));
   new_exit_status->pid = pid;
   new_exit_status->ppid = ppid;
+  new_exit_status->thread = thread;
   new_exit_status->status = status;
+  new_exit_status->usage = *usage;
   new_exit_status->next = exit_status_tail;
   new_exit_status->prev = exit_status_tail->prev;
   exit_status_tail->prev->next = new_exit_status;
@@ -50,9 +52,33 @@ int removeExitStatus(int ppid, int *status)
       // but we will remove all the matching status
       current->prev->next = current->next;
       current->next->prev = current->prev;
+      struct ExitStatus *next = current->next;
       free(current);
+      current = next;
+      continue;
     }
     current = current->next;
   }
   return pid;
-}
\ No newline at end of file
+}
+
+int takeExitStatus(int ppid, int pid, int thread, int *status, struct process_usage *usage)
+{
+  struct ExitStatus *current = exit_status_head->next;
+  while (current != exit_status_tail)
+  {
+    if (current->ppid == ppid && current->thread == thread && (pid == -1 || current->pid == pid))
+    {
+      *status = current->status;
+      if (usage != NULL)
+        *usage = current->usage;
+      pid = current->pid;
+      current->prev->next = current->next;
+      current->next->prev = current->prev;
+      free(current);
+      return pid;
+    }
+    current = current->next;
+  }
+  return -1;
+}
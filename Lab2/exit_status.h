@@ -3,12 +3,15 @@
 // this file stores information about the exit status
 #include <comp421/hardware.h>
 #include <comp421/loadinfo.h>
+#include "kernel_call.h"
 
 typedef struct ExitStatus
 {
   int status;
   int pid;
-  int ppid;
+  int ppid;                   // the pid of the parent, or of the main thread for a thread
+  int thread;                 // 1 if the status is for ThreadJoin instead of Wait
+  struct process_usage usage; // the final resource usage of the process
   struct ExitStatus *next;
   struct ExitStatus *prev;
 } ExitStatus;
@@ -16,9 +19,9 @@ typedef struct ExitStatus
 // initialize the exit status list
 void initExitStatusList();
 
-// add the parent pid and the exit status to the list
-// waiting to be collected by the parent
-void addExitStatus(int pid, int ppid, int status);
+// add the parent pid, the exit status and the final usage to the list
+// waiting to be collected by the parent, or by ThreadJoin if thread is set
+void addExitStatus(int pid, int ppid, int thread, int status, struct process_usage *usage);
 
 // remove all the exit status that belongs to this pid
 // return the first exit status's pid as the result
@@ -26,6 +29,13 @@ void addExitStatus(int pid, int ppid, int status);
 // if there is no exit status for this pid, return -1
 int removeExitStatus(int ppid, int *status);
 
+// remove only the first exit status of the child pid that belongs to this ppid
+// pid -1 means any child, the status will be stored in the status pointer
+// and the usage in the usage pointer, unless it is NULL
+// thread selects the exit status of a thread instead of a child
+// return the pid of the child, or -1 if there is no matching exit status
+int takeExitStatus(int ppid, int pid, int thread, int *status, struct process_usage *usage);
+
 void printExitStatusList();
 
 #endif // YALNIX_EXIT_STATUS_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcb.h"
+#include "pte.h"
+#include "futex.h"
+
+static struct futex futexes[MAX_FUTEXES];
+
+void initFutexes()
+{
+  memset(futexes, 0, sizeof(futexes));
+  int i;
+  for (i = 0; i < MAX_FUTEXES; i++)
+    initWaitQueue(&futexes[i].waiters, USAGE_WAIT, 0);
+}
+
+uintptr_t getFutexKey(uintptr_t addr)
+{
+  struct pte *page_table = PAGE_TABLE_0_VADDR;
+  return ((uintptr_t)page_table[addr >> PAGESHIFT].pfn << PAGESHIFT) | (addr & PAGEOFFSET);
+}
+
+// the slot the search for the key starts at, words are aligned so the low bits say nothing
+static int hashFutexKey(uintptr_t key)
+{
+  return (key >> 2) & (MAX_FUTEXES - 1);
+}
+
+// find the slot of the key among the slots with waiters, NULL if nobody waits on the word
+// a slot is freed as soon as its queue is empty, so the search goes over every slot
+// but starting at the hash it usually stops at the first one
+static struct futex *findFutex(uintptr_t key, struct futex **free_slot)
+{
+  int start = hashFutexKey(key);
+  int i;
+  if (free_slot != NULL)
+    *free_slot = NULL;
+  for (i = 0; i < MAX_FUTEXES; i++)
+  {
+    struct futex *futex = &futexes[(start + i) & (MAX_FUTEXES - 1)];
+    if (isWaitQueueEmpty(&futex->waiters))
+    {
+      if (free_slot != NULL && *free_slot == NULL)
+        *free_slot = futex;
+    }
+    else if (futex->key == key)
+      return futex;
+  }
+  return NULL;
+}
+
+struct wait_queue *getFutexQueue(uintptr_t key)
+{
+  struct futex *free_slot;
+  struct futex *futex = findFutex(key, &free_slot);
+  if (futex == NULL)
+  {
+    if (free_slot == NULL)
+    {
+      TracePrintf(0, "getFutexQueue: every futex slot has waiters\n");
+      return NULL;
+    }
+    futex = free_slot;
+    futex->key = key;
+  }
+  return &futex->waiters;
+}
+
+int wakeFutex(uintptr_t key, int count)
+{
+  struct futex *futex = findFutex(key, NULL);
+  if (futex == NULL)
+    return 0;
+  int woken = 0;
+  while (woken < count && wakeOne(&futex->waiters) != NULL)
+    woken++;
+  TracePrintf(3, "wakeFutex: woke %d processes waiting on 0x%x\n", woken, key);
+  return woken;
+}
@@ -0,0 +1,31 @@
+#ifndef YALNIX_FUTEX_H
+#define YALNIX_FUTEX_H
+#include <stdint.h>
+#include "wait_queue.h"
+// this file keeps the queues of the processes waiting on a word of user memory
+// a word is named by its physical address, so every thread mapping the word finds the same queue
+// the kernel only sees the contended case, the user library takes a free lock without a trap
+
+// the most words that can have waiters at the same time, a power of two
+#define MAX_FUTEXES 64
+
+struct futex
+{
+  uintptr_t key;             // the physical address of the word
+  struct wait_queue waiters; // the slot is free when nobody waits on it
+};
+
+// initialize the table of futexes
+void initFutexes();
+
+// get the physical address of the user address, which must be mapped in the current page table
+uintptr_t getFutexKey(uintptr_t addr);
+
+// get the queue of the word with the key, taking a free slot if nobody waits on it yet
+// return NULL if every slot has waiters
+struct wait_queue *getFutexQueue(uintptr_t key);
+
+// wake at most count processes waiting on the word with the key, return how many were woken
+int wakeFutex(uintptr_t key, int count);
+
+#endif // YALNIX_FUTEX_H
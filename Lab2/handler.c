@@ -1,9 +1,11 @@
 #include <comp421/hardware.h>
 #include <comp421/yalnix.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "handler.h"
+#include "clock.h"
 #include "pcb.h"
 #include "switch.h"
 #include "page.h"
@@ -12,12 +14,80 @@
 #include "exit_status.h"
 #include "terminal.h"
 #include "tty_buffer.h"
+#include "kernel_call.h"
+#include "deadline.h"
+#include "container.h"
+#include "wait_queue.h"
+#include "pty.h"
+#include "pipe.h"
+#include "kernel_object.h"
+#include "ipc.h"
+#include "sync.h"
+#include "futex.h"
+#include "info_page.h"
 
 static int clock_ticks = 0;
 
 // every process has 2 clock ticks
 #define CLOCK_INTERVAL 2
 
+// what a process woken up by terminal I/O does to the current process, see SetWakePreempt
+static int wake_preempt_policy = WAKE_PREEMPT_PRIORITY;
+
+// the tick used when nothing is going to expire
+#define NO_EXPIRY INT_MAX
+
+// the processes in Delay or a timed wait, sorted by wake_tick
+static struct wait_queue timer_queue;
+
+// the earliest tick that any delay or timed wait expires at, computed whenever one is added or expired
+// so the clock handler only needs to compare it with the tick count
+static int next_expiry_tick = NO_EXPIRY;
+
+void initTimers()
+{
+  initWaitQueue(&timer_queue, USAGE_DELAY, 1);
+}
+
+// sleep on the timer queue and the count other queues until the tick, return the queue that woke us up
+// the timer queue is appended to queues, so it must have room for one more
+static struct wait_queue *sleepUntil(int wake_tick, struct wait_queue **queues, int count)
+{
+  struct pcb *current_process = getCurrentProcess();
+  current_process->wake_tick = wake_tick;
+  if (wake_tick < next_expiry_tick)
+    next_expiry_tick = wake_tick;
+  queues[count] = &timer_queue;
+  return sleepOnMany(queues, count + 1);
+}
+
+// recompute next_expiry_tick from the head of the timer queue and the deadline processes
+static void updateNextExpiry()
+{
+  struct pcb *first_timer_process = peekWaitQueue(&timer_queue);
+  next_expiry_tick = NO_EXPIRY;
+  if (first_timer_process != NULL)
+    next_expiry_tick = first_timer_process->wake_tick;
+  // the end of a period of a deadline process is also a timer event
+  int next_deadline_tick = getNextDeadlineTick();
+  if (next_deadline_tick < next_expiry_tick)
+    next_expiry_tick = next_deadline_tick;
+}
+
+// wake up the delays and timed waits expiring at the current tick
+static void expireTimers()
+{
+  // the timer queue is sorted, so we only look at the front of it
+  int tick = getTickCount();
+  struct pcb *timer_process;
+  while ((timer_process = peekWaitQueue(&timer_queue)) != NULL && timer_process->wake_tick <= tick)
+    wakeProcess(timer_process, &timer_queue);
+
+  rollDeadlines(tick);
+
+  updateNextExpiry();
+}
+
 // check if the address is valid for the user for the specific protection
 // return 1 is valid, 0 is invalid
 static int validateAddr(uintptr_t addr, int prot)
@@ -110,24 +180,81 @@ static int validateString(uintptr_t addr, int prot)
   return 1;
 }
 
-static void writeToTerminal(int tty_id, void *buf, int len)
+// wake up the first process blocked on the terminal queue
+// it gets a priority boost, and may preempt the current process according to wake_preempt_policy
+static void wakeUpForIo(struct wait_queue *queue)
+{
+  struct pcb *woken_process = wakeOne(queue);
+  if (woken_process == NULL)
+    return;
+
+  TracePrintf(3, "wakeUpForIo: process %d is woken up by the terminal\n", woken_process->pid);
+  if (woken_process->priority < MAX_PRIORITY)
+    woken_process->priority++;
+
+  struct pcb *current_process = getCurrentProcess();
+  // there is no reason to let the idle process pause until the next clock tick
+  // but the woken process may still have to wait for its container's next cpu period
+  if (current_process == getIdleProcess())
+  {
+    struct pcb *next_process = getNextProcess(0);
+    if (next_process != current_process)
+      ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
+    return;
+  }
+
+  // a process of a throttled container has to wait for its next cpu period like everyone else
+  if (wake_preempt_policy == WAKE_PREEMPT_PRIORITY && woken_process->priority > current_process->priority && !isContainerThrottled(woken_process->container, getTickCount()))
+  {
+    TracePrintf(3, "wakeUpForIo: process %d with priority %d preempts process %d with priority %d\n", woken_process->pid, woken_process->priority, current_process->pid, current_process->priority);
+    // the woken process starts a new quantum
+    clock_ticks = 0;
+    current_process->usage.involuntary_switches++;
+    ContextSwitch(NormalSwitch, &current_process->ctx, current_process, woken_process);
+  }
+}
+
+// wait for the line being transmitted on the terminal to finish
+static void waitTtyTransmit(int tty_id)
+{
+  while (getTerminalTransmitStatus(tty_id) == BUSY)
+  {
+    TracePrintf(3, "blocked the writing process with pid=%d\n", getCurrentProcess()->pid);
+    sleepOn(getTtyTransmitQueue(tty_id));
+    TracePrintf(3, "switched back in TtyWrite, now process with pid=%d able to write to terminal %d\n", getCurrentProcess()->pid, tty_id);
+  }
+}
+
+// the writes that fit into the transmit ring return as soon as they are copied into it
+// the longer ones wait for the ring to drain, then go out straight from the writer's pages
+// return len, or ERROR if the pages of a long write went away before all of it was transmitted
+static int writeToTerminal(int tty_id, void *buf, int len)
 {
   struct pcb *current_process = getCurrentProcess();
-  current_process->tty_write_id = tty_id;
+  // the whole buffer goes out before the next writer gets the terminal
+  acquireTtyWriter(tty_id);
+  // we may have waited for the terminal, and the buffer with us
+  if (!validatePointer((uintptr_t)buf, len, PROT_READ))
+  {
+    releaseTtyWriter(tty_id);
+    return ERROR;
+  }
+
+  if (len <= TTY_TRANSMIT_RING_SIZE)
+  {
+    int result = queueTtyOutput(tty_id, buf, len);
+    releaseTtyWriter(tty_id);
+    TracePrintf(3, "TtyWrite for process with pid=%d queued\n", current_process->pid);
+    return result == ERROR ? ERROR : len;
+  }
+
+  while (!isTtyDrained(tty_id))
+    sleepOn(getTtyTransmitQueue(tty_id));
+
   int trans_index = 0;
   while (trans_index < len)
   {
-    if (getTerminalTransmitStatus(tty_id) == BUSY)
-    {
-      struct pcb *next_process = getNextProcess(0);
-      TracePrintf(3, "blocked the writing process with pid=%d, switching to next process with pid=%d\n", current_process->pid, next_process->pid);
-      // remove it from the execution list
-      removeProcessFromList(current_process);
-      addProcessToList(current_process, TTY_WRITE_LIST);
-
-      ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
-      TracePrintf(3, "switched back in TtyWrite, now process with pid=%d able to write to terminal %d\n", current_process->pid, tty_id);
-    }
+    waitTtyTransmit(tty_id);
 
     int trans_index_next = trans_index + TERMINAL_MAX_LINE;
     if (trans_index_next > len)
@@ -136,28 +263,143 @@ static void writeToTerminal(int tty_id, void *buf, int len)
     int trans_len = trans_index_next - trans_index;
 
     TracePrintf(3, "string too long, transmiting the %d chars first\n", trans_len);
-    // int transmit_len = getBuf(tty_transmit_buf, buf, TERMINAL_MAX_LINE, 0);
-    // TracePrintf(3, "get %d chars from tty_transmit_buf, the size of tty_transmit_buf now: %d\n", transmit_len, tty_transmit_buf->size);
-    TtyTransmit(tty_id, buf + trans_index, trans_len);
+    if (transmitUserLine(tty_id, buf + trans_index, trans_len) == ERROR)
+    {
+      releaseTtyWriter(tty_id);
+      return ERROR;
+    }
     setTerminalTransmitStatus(tty_id, BUSY);
 
     trans_index = trans_index_next;
   }
 
-  if (getTerminalTransmitStatus(tty_id) == BUSY)
+  waitTtyTransmit(tty_id);
+  releaseTtyWriter(tty_id);
+
+  TracePrintf(3, "TtyWrite for process with pid=%d done\n", current_process->pid);
+  return len;
+}
+
+// read from the terminal by its line discipline, a line at a time in canonical mode
+// and in raw mode as soon as min chars are there, or whatever is there when the timeout is up
+static int readFromTerminal(int tty_id, void *buf, int len)
+{
+  struct pcb *current_process = getCurrentProcess();
+  tty_buf *tty_receive_buf = getTtyReceiveBuf(tty_id);
+  int min, timeout;
+
+  if (getTtyMode(tty_id, &min, &timeout) == TTY_MODE_CANONICAL)
   {
-    struct pcb *next_process = getNextProcess(0);
-    TracePrintf(3, "blocked the writing process with pid=%d, switching to next process with pid=%d\n", current_process->pid, next_process->pid);
-    // remove it from the execution list
-    removeProcessFromList(current_process);
-    addProcessToList(current_process, TTY_WRITE_LIST);
+    // block the current reading process, another reader may have taken the line before we run again
+    while (isEmpty(tty_receive_buf))
+    {
+      TracePrintf(3, "terminal %d has nothing to read from yet, blocking the reading process with pid=%d\n", tty_id, current_process->pid);
+      sleepOn(getTtyReadQueue(tty_id));
+      TracePrintf(3, "switched back in TtyRead, now process with pid=%d able to read terminal %d\n", current_process->pid, tty_id);
+      if (!validatePointer((uintptr_t)buf, len, PROT_WRITE))
+        return ERROR;
+    }
 
-    ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
-    TracePrintf(3, "switched back in TtyWrite, now process with pid=%d able to write to terminal %d\n", current_process->pid, tty_id);
+    // a line longer than len is left for the next read
+    return readTtyLine(tty_id, buf, len);
   }
 
-  TracePrintf(3, "TtyWrite for process with pid=%d done\n", current_process->pid);
-  current_process->tty_write_id = -1;
+  if (min > len)
+    min = len;
+  // with no min, a timed read still waits for the first char
+  int wanted = min == 0 && timeout > 0 ? 1 : min;
+  int wake_tick = getTickCount() + timeout;
+  struct wait_queue *queues[2] = {getTtyReadQueue(tty_id)};
+  while (tty_receive_buf->size < wanted)
+  {
+    TracePrintf(3, "terminal %d has %d out of %d chars, blocking the reading process with pid=%d\n", tty_id, tty_receive_buf->size, wanted, current_process->pid);
+    struct wait_queue *woken_by = queues[0];
+    if (timeout == 0)
+      sleepOn(queues[0]);
+    else
+      woken_by = sleepUntil(wake_tick, queues, 1);
+    if (!validatePointer((uintptr_t)buf, len, PROT_WRITE))
+      return ERROR;
+    if (woken_by == &timer_queue)
+      break;
+  }
+
+  return getBuf(tty_receive_buf, buf, len, 0);
+}
+
+static int mayUsePty(int tty_id);
+
+// set the revents of the terminals (and pty ends) in fds, return the number of them that are ready
+// or ERROR if one of the terminals does not exist
+static int checkPollFds(struct poll_fd *fds, int n)
+{
+  int ready = 0;
+  int i;
+  for (i = 0; i < n; i++)
+  {
+    int tty_id = fds[i].tty_id;
+    int pty = isPty(tty_id);
+    if ((tty_id < 0 || tty_id >= NUM_TERMINALS) && !pty)
+      return ERROR;
+    if (pty && !mayUsePty(tty_id))
+      return ERROR;
+
+    fds[i].revents = 0;
+    if ((fds[i].events & POLL_READ) && (pty ? isPtyReadable(tty_id) : isTtyReadable(tty_id)))
+      fds[i].revents |= POLL_READ;
+    if ((fds[i].events & POLL_WRITE) && (pty ? isPtyWritable(tty_id) : isTtyWritable(tty_id)))
+      fds[i].revents |= POLL_WRITE;
+    if (fds[i].revents)
+      ready++;
+  }
+  return ready;
+}
+
+// a poll sleeps on every terminal, the queue of the pty ends and the timer queue at once
+#if NUM_TERMINALS + 2 > MAX_WAIT_QUEUES
+#error "MAX_WAIT_QUEUES is too small to poll every terminal"
+#endif
+
+// wait for one of the terminals in fds to become ready, sleeping on all their poll queues at once
+static int pollTerminals(struct poll_fd *fds, int n, int timeout)
+{
+  int wake_tick = getTickCount() + timeout;
+  while (1)
+  {
+    int ready = checkPollFds(fds, n);
+    if (ready != 0 || timeout == 0 || (timeout > 0 && getTickCount() >= wake_tick))
+      return ready;
+
+    // each terminal once, the pty ends share one queue, and room for the timer queue
+    struct wait_queue *queues[NUM_TERMINALS + 2];
+    int count = 0;
+    int tty_id;
+    int i;
+    for (tty_id = 0; tty_id < NUM_TERMINALS; tty_id++)
+      for (i = 0; i < n; i++)
+        if (fds[i].tty_id == tty_id && fds[i].events)
+        {
+          queues[count++] = getTtyPollQueue(tty_id);
+          break;
+        }
+    for (i = 0; i < n; i++)
+      if (fds[i].tty_id >= NUM_TERMINALS && fds[i].events)
+      {
+        queues[count++] = getPtyPollQueue();
+        break;
+      }
+
+    TracePrintf(3, "pollTerminals: process %d polls %d terminals\n", getCurrentProcess()->pid, count);
+    if (timeout > 0)
+      sleepUntil(wake_tick, queues, count);
+    else if (count > 0)
+      sleepOnMany(queues, count);
+    else
+      // nothing to wait for and no timeout, it would never return
+      return 0;
+    if (!validatePointer((uintptr_t)fds, n * sizeof(struct poll_fd), PROT_READ | PROT_WRITE))
+      return ERROR;
+  }
 }
 
 static void writeStrToTerminal(int tty_id, char *str)
@@ -166,43 +408,254 @@ static void writeStrToTerminal(int tty_id, char *str)
   writeToTerminal(tty_id, str, len);
 }
 
+// deliver the exit status of the process to its parent
+// and wake the parent up if it is waiting for this child (or any child)
+// a thread is not a child, its exit status goes to the other threads of its process for ThreadJoin
+static void notifyParent(struct pcb *pcb, int status)
+{
+  struct process_usage usage;
+  if (pcb->pid != pcb->tgid)
+  {
+    // nobody is left to join the last thread
+    if (pcb->space->users > 1)
+    {
+      getProcessUsage(pcb, &usage);
+      addExitStatus(pcb->pid, pcb->tgid, 1, status, &usage);
+      wakeAll(&pcb->space->thread_exit);
+    }
+    return;
+  }
+
+  struct pcb *parent_process = getProcessByPid(pcb->ppid);
+  if (parent_process == NULL)
+    return;
+
+  parent_process->child_count--;
+
+  // only when the parent still exist, we will add the exit status (to avoid useless exit status)
+  getProcessUsage(pcb, &usage);
+  addExitStatus(pcb->pid, pcb->ppid, 0, status, &usage);
+
+  if (parent_process->wait_pid == -1 || parent_process->wait_pid == pcb->pid)
+    wakeAll(&parent_process->child_exit);
+}
+
+static void killProcess(struct pcb *target);
+
+// end the threads sharing the address space of the pcb, except the current process
+static void killOtherThreads(struct pcb *pcb)
+{
+  int max = pcb->space->users;
+  struct pcb **threads = malloc(max * sizeof(struct pcb *));
+  int count = getOtherThreads(pcb, threads, max);
+  int i;
+  for (i = 0; i < count; i++)
+    if (threads[i] != getCurrentProcess())
+      killProcess(threads[i]);
+  free(threads);
+}
+
+// whether the target is a thread of the process or one of its descendants
+// a child forked by any of the threads of the process is its descendant
+static int isDescendant(struct pcb *process, struct pcb *target)
+{
+  if (target->tgid == process->tgid)
+    return 1;
+
+  // walk up the parents of the target
+  int pid = target->ppid;
+  while (pid >= INIT_PROCESS)
+  {
+    struct pcb *ancestor = getProcessByPid(pid);
+    if (ancestor == NULL)
+      return 0;
+    if (ancestor->tgid == process->tgid)
+      return 1;
+    pid = ancestor->ppid;
+  }
+  return 0;
+}
+
+// the ends of a pair may be used by the process that opened it and its descendants
+static int mayUsePty(int tty_id)
+{
+  struct pcb *owner = getProcessByPid(getPtyOwner(tty_id));
+  return owner != NULL && isDescendant(owner, getCurrentProcess());
+}
+
+// a process may kill its own threads and its descendants, but never init
+static int mayKill(struct pcb *killer, struct pcb *target)
+{
+  if (target->tgid == killer->tgid)
+    return 1;
+  if (target->tgid == INIT_PROCESS)
+    return 0;
+  return isDescendant(killer, target);
+}
+
 // utility function to exit the current process and get the next one running
+// the process ends with its main thread, so the other threads are ended first
 static void exitProcess(int status)
 {
   TracePrintf(2, "exitProcess: exit process is called\n");
   struct pcb *current_process = getCurrentProcess();
+  if (current_process->pid == current_process->tgid && current_process->space->users > 1)
+    killOtherThreads(current_process);
   struct pcb *next_process = getNextProcess(0);
-  struct pcb *wait_process = getList(WAIT_LIST);
-  wait_process = wait_process->next;
-  while (wait_process->pid >= 0)
+
+  notifyParent(current_process, status);
+
+  // give the utilization back to the other deadline processes
+  clearDeadline(current_process);
+  // the frames stay charged to the container until ExitSwitch frees them
+  leaveContainer(current_process);
+
+  int dummy_status;
+  // remove the exit status of the current process's children
+  removeExitStatus(current_process->pid, &dummy_status);
+  // the processes sending to it get ERROR
+  dropMessages(current_process);
+  dropLocks(current_process);
+  dropPtys(current_process);
+
+  // take the exiting process off the execution list, it may be the last one
+  removeProcessFromList(current_process);
+  if (countProcess() == 0)
+  {
+    TracePrintf(2, "exitProcess: no more process, halt the system\n");
+    Halt();
+  }
+
+  ContextSwitch(ExitSwitch, &current_process->ctx, current_process, next_process);
+}
+
+// utility function to end a process other than the current one, wherever it is blocked
+// its frames are freed right away through the helper page, without switching to it
+static void killProcess(struct pcb *target)
+{
+  TracePrintf(2, "killProcess: process %d is killed by process %d\n", target->pid, getCurrentProcess()->pid);
+
+  // killing the main thread ends the whole process
+  if (target->pid == target->tgid && target->space->users > 1)
+    killOtherThreads(target);
+
+  notifyParent(target, EXIT_KILLED);
+  clearDeadline(target);
+  leaveContainer(target);
+
+  int dummy_status;
+  removeExitStatus(target->pid, &dummy_status);
+
+  // it may be runnable or sleeping on any number of wait queues
+  leaveWaitQueues(target);
+  removeProcessFromList(target);
+  // the writers waiting behind it must not wait forever
+  dropTtyWriter(target);
+  dropMessages(target);
+  dropLocks(target);
+  dropPtys(target);
+
+  struct address_space *space = target->space;
+  space->users--;
+  if (space->users > 0)
+  {
+    // the other threads keep the address space, only the kernel stack of the target goes away
+    int i;
+    for (i = 0; i < KERNEL_STACK_PAGES; i++)
+      freePage(target->kernel_stack[i]);
+  }
+  else
   {
-    // if the parent process is in the wait list
-    if (wait_process->pid == current_process->ppid)
+    // the kernel stack in the page table may belong to a thread that has already exited
+    freePageTable(space->page_table, !target->has_kernel_stack);
+    if (target->has_kernel_stack)
     {
-      // we will wake up the parent process
-      removeProcessFromList(wait_process);
-      addProcessToList(wait_process, EXECUTION_LIST);
-      // there shall only be one parent process
-      break;
+      int i;
+      for (i = 0; i < KERNEL_STACK_PAGES; i++)
+        freePage(target->kernel_stack[i]);
     }
-    wait_process = wait_process->next;
+    free(space);
   }
+  free(target);
+}
 
-  // though this kind of duplicated with the above code, we will still do it this way
-  struct pcb *parent_process = getProcessByPid(current_process->ppid);
-  if (parent_process != NULL)
+// wait for the thread with the tid of the current process to exit, any thread of the process may join it
+// return 0, or ERROR if there is no such thread
+static int joinThread(int tid, int *status)
+{
+  struct pcb *current_process = getCurrentProcess();
+  while (takeExitStatus(current_process->tgid, tid, 1, status, NULL) == -1)
   {
-    parent_process->child_count--;
-
-    // only when the parent still exist, we will add the exit status (to avoid useless exit status)
-    addExitStatus(current_process->ppid, current_process->ppid, status);
+    // the main thread is never joined, the process ends with it
+    struct pcb *thread = getProcessByPid(tid);
+    if (thread == NULL || thread == current_process || thread->space != current_process->space || thread->pid == thread->tgid)
+    {
+      TracePrintf(0, "joinThread: %d is not a thread of process %d\n", tid, current_process->tgid);
+      return ERROR;
+    }
+    sleepOn(&current_process->space->thread_exit);
+    if (!validatePointer((uintptr_t)status, sizeof(int), PROT_READ | PROT_WRITE))
+      return ERROR;
   }
+  return 0;
+}
 
-  int dummy_status;
-  // remove the exit status of the current process's children
-  removeExitStatus(current_process->pid, &dummy_status);
+// utility function to wait for a child of the current process to exit, pid -1 means any child
+// the children belong to the process, so any of its threads may wait for them on the main thread
+// the final usage of the child goes to usage, unless it is NULL
+// return the pid of the child, 0 if nothing exited in time (WNOHANG or timeout), or ERROR
+static int waitChild(int pid, int *status, int options, int timeout, struct process_usage *usage)
+{
+  struct pcb *current_process = getCurrentProcess();
+  // the main thread outlives the others, ending it ends them
+  struct pcb *parent_process = getProcessByPid(current_process->tgid);
+  int wake_tick = getTickCount() + timeout;
 
-  ContextSwitch(ExitSwitch, &current_process->ctx, current_process, next_process);
+  while (1)
+  {
+    int child_pid = takeExitStatus(parent_process->pid, pid, 0, status, usage);
+    if (child_pid != -1)
+      return child_pid;
+
+    // a specific pid must be one of our running children, else it can never exit for us
+    if (pid == -1)
+    {
+      if (parent_process->child_count == 0)
+      {
+        writeStrToTerminal(TTY_CONSOLE, "No children left\n");
+        return ERROR;
+      }
+    }
+    else
+    {
+      struct pcb *child_process = getProcessByPid(pid);
+      if (child_process == NULL || child_process->ppid != parent_process->pid)
+      {
+        TracePrintf(0, "waitChild: process %d is not a child of process %d\n", pid, parent_process->pid);
+        return ERROR;
+      }
+    }
+
+    if (options & WNOHANG)
+      return 0;
+
+    // threads waiting for different children are all woken up by any child
+    if (isWaitQueueEmpty(&parent_process->child_exit))
+      parent_process->wait_pid = pid;
+    else if (parent_process->wait_pid != pid)
+      parent_process->wait_pid = -1;
+
+    // the exiting child will wake us up, and so will the timer of a timed wait
+    struct wait_queue *queues[2] = {&parent_process->child_exit};
+    if (timeout <= 0)
+      sleepOn(&parent_process->child_exit);
+    else if (sleepUntil(wake_tick, queues, 1) == &timer_queue)
+      return 0;
+
+    // after switching back, we will check the exit status again, into buffers that may be gone by now
+    if (!validatePointer((uintptr_t)status, sizeof(int), PROT_READ | PROT_WRITE) || (usage != NULL && !validatePointer((uintptr_t)usage, sizeof(struct process_usage), PROT_READ | PROT_WRITE)))
+      return ERROR;
+  }
 }
 
 // the hander for system calles (trap kernel)
@@ -214,8 +667,9 @@ void onTrapKernel(ExceptionInfo *info)
   {
     TracePrintf(2, "onTrapKernel: fork is called\n");
     struct pcb *current_process = getCurrentProcess();
-    int page_count = countPageTableEntries();
-    if (getPageCount() < page_count)
+    // the copy of the pages and the new page table, within the limit of the container
+    int page_count = countPageTableEntries() + 1;
+    if (getFramesLeft() < page_count)
     {
       TracePrintf(0, "onTrapKernel: not enough pages to allocate for fork\n");
       info->regs[0] = -1;
@@ -233,23 +687,29 @@ void onTrapKernel(ExceptionInfo *info)
       info->regs[0] = -1;
       break;
     }
-    new_process->page_table = page_table;
+    struct address_space *space = createAddressSpace(new_process, page_table);
 
     // we need to copy the usage information of the page table
-    new_process->brk = current_process->brk;
-    new_process->stk = current_process->stk;
+    space->brk = current_process->space->brk;
+    space->stk = current_process->space->stk;
     addProcessToList(new_process, EXECUTION_LIST);
-    new_process->ppid = current_process->pid;
-    current_process->child_count++;
-
+    // a child forked by a thread is a child of the process, and outlives the thread
+    new_process->ppid = current_process->tgid;
+    new_process->pgid = current_process->pgid;
+    memcpy(new_process->tty_flags, current_process->tty_flags, sizeof(new_process->tty_flags));
+    getProcessByPid(current_process->tgid)->child_count++;
+    joinContainer(new_process, current_process->container);
+
+    // the child may have exited before we run again, so keep its pid
+    int new_pid = new_process->pid;
     ContextSwitch(ForkSwitch, &current_process->ctx, current_process, new_process);
 
     current_process = getCurrentProcess();
-    if (current_process->pid == new_process->pid)
+    if (current_process->pid == new_pid)
       // if we are the child process, we will return 0
       info->regs[0] = 0;
     else
-      info->regs[0] = new_process->pid;
+      info->regs[0] = new_pid;
 
     break;
   }
@@ -257,6 +717,14 @@ void onTrapKernel(ExceptionInfo *info)
   {
     TracePrintf(2, "onTrapKernel: exec is called\n");
 
+    // the other threads would lose their code and stacks under them
+    if (getCurrentProcess()->space->users > 1)
+    {
+      TracePrintf(0, "onTrapKernel: exec is called by a process with threads\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
     char *filename = (char *)info->regs[1];
     char **args = (char **)info->regs[2];
 
@@ -308,14 +776,8 @@ void onTrapKernel(ExceptionInfo *info)
   case YALNIX_WAIT:
   {
     TracePrintf(2, "onTrapKernel: wait is called\n");
-    // int *status = (int *)info->regs[1];
     // if there is already a child process exited, we will return the status
     // else we will add the current process to the wait list
-    // int *status = (int *)info->regs[1];
-    // if there is already a child process exited, we will return the status
-    // else we will add the current process to the wait list
-
-    struct pcb *current_process = getCurrentProcess();
     int *status = (int *)info->regs[1];
 
     if (!validatePointer((uintptr_t)status, sizeof(int), PROT_READ | PROT_WRITE))
@@ -325,42 +787,44 @@ void onTrapKernel(ExceptionInfo *info)
       info->regs[0] = ERROR;
       break;
     }
-    int pid = -1;
 
-    do
+    info->regs[0] = waitChild(-1, status, 0, 0, NULL);
+    break;
+  }
+  case YALNIX_WAITPID:
+  {
+    int pid = (int)info->regs[1];
+    int *status = (int *)info->regs[2];
+    int options = (int)info->regs[3];
+    int timeout = (int)info->regs[4];
+    struct process_usage *usage = (struct process_usage *)info->regs[5];
+
+    TracePrintf(2, "onTrapKernel: waitpid is called for pid %d with options %d and timeout %d\n", pid, options, timeout);
+
+    if (!validatePointer((uintptr_t)status, sizeof(int), PROT_READ | PROT_WRITE))
     {
-      pid = removeExitStatus(current_process->pid, status);
-      if (pid == -1)
-      {
-        // if there is no child process exited
-        // we will need to verify this process has children
-        if (current_process->child_count > 0)
-        {
-          struct pcb *next_process = getNextProcess(0);
-          // if there are children, we will add the current process to the wait list
-          removeProcessFromList(current_process);
-          addProcessToList(current_process, WAIT_LIST);
-          printList(WAIT_LIST);
-          printList(EXECUTION_LIST);
-          // we will switch to the next process
-          ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
-          // after switching back, we will reenter the loop
-        }
-        else
-        {
-          // if there is no child process, we will return -1
-          writeStrToTerminal(TTY_CONSOLE, "No children left\n");
-          info->regs[0] = ERROR;
-          break;
-        }
-      }
-      else
-      {
-        info->regs[0] = pid;
-        break;
-      }
-    } while (pid == -1);
+      TracePrintf(0, "onTrapKernel: waitpid status buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    if (usage != NULL && !validatePointer((uintptr_t)usage, sizeof(struct process_usage), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: waitpid usage buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    if (pid < -1 || pid == IDLE_PROCESS)
+    {
+      TracePrintf(0, "onTrapKernel: waitpid pid %d is invalid\n", pid);
+      info->regs[0] = ERROR;
+      break;
+    }
 
+    info->regs[0] = waitChild(pid, status, options, timeout, usage);
     break;
   }
   case YALNIX_GETPID:
@@ -381,28 +845,28 @@ void onTrapKernel(ExceptionInfo *info)
     uintptr_t next_brk = (uintptr_t)(UP_TO_PAGE((uintptr_t)info->regs[1]));
     // we will leave a page between the brk and the stack
     // in this case we will not allocate the page
-    if (next_brk + PAGESIZE > current_process->stk)
+    if (next_brk + PAGESIZE > current_process->space->stk)
     {
       TracePrintf(0, "onTrapKernel: out of virtual memory\n");
       info->regs[0] = -1;
       break;
     }
-    if (next_brk < current_process->brk)
+    if (next_brk < current_process->space->brk)
     {
       // this means we need to free some pages
-      int page_count = (current_process->brk - next_brk) >> PAGESHIFT;
-      TracePrintf(3, "onTrapKernel: we need to free %d pages, current break is at 0x%x, and new break is 0x%x\n", page_count, current_process->brk, next_brk);
+      int page_count = (current_process->space->brk - next_brk) >> PAGESHIFT;
+      TracePrintf(3, "onTrapKernel: we need to free %d pages, current break is at 0x%x, and new break is 0x%x\n", page_count, current_process->space->brk, next_brk);
       int i;
       for (i = 0; i < page_count; i++)
       {
-        uintptr_t virtual_addr = (uintptr_t)current_process->brk - ((i + 1) << PAGESHIFT);
+        uintptr_t virtual_addr = (uintptr_t)current_process->space->brk - ((i + 1) << PAGESHIFT);
         removePageTableEntry(PAGE_TABLE_0_VADDR, virtual_addr, 1);
       }
     }
     else
     {
-      int page_count = (next_brk - current_process->brk) >> PAGESHIFT;
-      TracePrintf(3, "onTrapKernel: we need to add %d pages, current break is at 0x%x, and new break is 0x%x\n", page_count, current_process->brk, next_brk);
+      int page_count = (next_brk - current_process->space->brk) >> PAGESHIFT;
+      TracePrintf(3, "onTrapKernel: we need to add %d pages, current break is at 0x%x, and new break is 0x%x\n", page_count, current_process->space->brk, next_brk);
       uintptr_t new_pages[page_count];
       if (allocateMultiPage(page_count, new_pages) == -1)
       {
@@ -410,15 +874,16 @@ void onTrapKernel(ExceptionInfo *info)
         info->regs[0] = -1;
         break;
       }
+      current_process->usage.brk_pages += page_count;
       // add these pages to region 0 page table
       int i;
       for (i = 0; i < page_count; i++)
       {
-        uintptr_t virtual_addr = (uintptr_t)current_process->brk + (i << PAGESHIFT);
+        uintptr_t virtual_addr = (uintptr_t)current_process->space->brk + (i << PAGESHIFT);
         writePageTableEntry(PAGE_TABLE_0_VADDR, virtual_addr, new_pages[i], PROT_READ | PROT_WRITE, PROT_READ | PROT_WRITE);
       }
     }
-    current_process->brk = next_brk;
+    current_process->space->brk = next_brk;
     info->regs[0] = 0;
     // printPageTableEntries(PAGE_TABLE_0_VADDR);
     break;
@@ -431,18 +896,10 @@ void onTrapKernel(ExceptionInfo *info)
       TracePrintf(0, "onTrapKernel: delay time is invalid\n");
       break;
     }
-    // we will remove the current process from the execution list
-    // and add it to the delay list, then execute the next process
-    struct pcb *current_process = getCurrentProcess();
-    struct pcb *next_process = getNextProcess(0);
-    current_process->delay = delay;
-
-    TracePrintf(2, "onTrapKernel: delay is called, current process is %d, next process is %d\n", current_process->pid, next_process->pid);
-    removeProcessFromList(current_process);
-    addProcessToList(current_process, DELAY_LIST);
-    printList(DELAY_LIST);
-    printList(EXECUTION_LIST);
-    ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
+    // we will put the current process on the timer queue, then execute the next process
+    TracePrintf(2, "onTrapKernel: delay is called, current process is %d\n", getCurrentProcess()->pid);
+    struct wait_queue *queues[1];
+    sleepUntil(getTickCount() + delay, queues, 0);
     break;
   case YALNIX_TTY_READ:
   {
@@ -450,6 +907,13 @@ void onTrapKernel(ExceptionInfo *info)
     void *buf = (void *)info->regs[2];
     int len = (int)info->regs[3];
 
+    if ((tty_id < 0 || tty_id >= NUM_TERMINALS) && !(isPty(tty_id) && mayUsePty(tty_id)))
+    {
+      TracePrintf(0, "onTrapKernel: tty read terminal %d is invalid\n", tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
     if (!validatePointer((uintptr_t)buf, len * sizeof(char), PROT_READ | PROT_WRITE))
     {
       TracePrintf(0, "onTrapKernel: tty read buffer is invalid\n");
@@ -466,34 +930,28 @@ void onTrapKernel(ExceptionInfo *info)
       break;
     }
 
-    struct pcb *current_process = getCurrentProcess();
-    struct pcb *next_process = getNextProcess(0);
-
-    tty_buf *tty_receive_buf = getTtyReceiveBuf(tty_id);
-
-    current_process->tty_read_id = tty_id;
-    // block the current reading process
-    if (isEmpty(tty_receive_buf))
+    // a pseudo-terminal has no hardware behind it, the chars come straight from the other end
+    if (isPty(tty_id))
     {
-      TracePrintf(3, "terminal %d has nothing to read from yet, blocking the reading process with pid=%d\n", tty_id, current_process->pid);
-      // remove it from the execution list
-      removeProcessFromList(current_process);
-      addProcessToList(current_process, TTY_READ_LIST);
+      len = readPty(tty_id, buf, len);
+      if (len > 0)
+        getCurrentProcess()->usage.tty_read_bytes += len;
+      info->regs[0] = len;
+      break;
+    }
 
-      TracePrintf(3, "blocked the reading process with pid=%d, switching to next process with pid=%d\n", current_process->pid, next_process->pid);
-      ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
-      TracePrintf(3, "switched back in TtyRead, now process with pid=%d able to read terminal %d\n", current_process->pid, tty_id);
+    if ((getCurrentProcess()->tty_flags[tty_id] & TTY_NONBLOCK) && !isTtyReadable(tty_id))
+    {
+      info->regs[0] = TTY_WOULD_BLOCK;
+      break;
     }
 
-    // when context switch back or even not go to the above if
-    // there must be something to read
-    len = getBuf(tty_receive_buf, buf, len, 1);
-    // return error if the char fails to write into the tty buffer
-    TracePrintf(3, "read %d chars from tty_receive_buf, the size of tty_receive_buf now: %d\n", len, tty_receive_buf->size);
-    current_process->tty_read_id = -1;
+    len = readFromTerminal(tty_id, buf, len);
+    TracePrintf(3, "read %d chars from terminal %d\n", len, tty_id);
 
-    // return error if the char fails to write into the user buffer
-    info->regs[0] = len ? len : ERROR;
+    // 0 chars is the end of the input, or a raw read that timed out
+    getCurrentProcess()->usage.tty_read_bytes += len;
+    info->regs[0] = len;
     break;
   }
   case YALNIX_TTY_WRITE:
@@ -502,6 +960,13 @@ void onTrapKernel(ExceptionInfo *info)
     void *buf = (void *)info->regs[2];
     int len = (int)info->regs[3];
 
+    if ((tty_id < 0 || tty_id >= NUM_TERMINALS) && !(isPty(tty_id) && mayUsePty(tty_id)))
+    {
+      TracePrintf(0, "onTrapKernel: tty write terminal %d is invalid\n", tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
     if (!validatePointer((uintptr_t)buf, len * sizeof(char), PROT_READ | PROT_WRITE))
     {
       TracePrintf(0, "onTrapKernel: tty write buffer is invalid\n");
@@ -518,17 +983,691 @@ void onTrapKernel(ExceptionInfo *info)
       break;
     }
 
-    // block the current writing process
-
-    // put it into a kernel buffer first
-    void *kernel_buf = malloc(len);
-    memcpy(kernel_buf, buf, len);
+    if (isPty(tty_id))
+    {
+      len = writePty(tty_id, buf, len);
+      if (len > 0)
+        getCurrentProcess()->usage.tty_write_bytes += len;
+      info->regs[0] = len;
+      break;
+    }
+
+    if (getCurrentProcess()->tty_flags[tty_id] & TTY_NONBLOCK)
+    {
+      len = tryQueueTtyOutput(tty_id, buf, len);
+      getCurrentProcess()->usage.tty_write_bytes += len;
+      info->regs[0] = len ? len : TTY_WOULD_BLOCK;
+      break;
+    }
 
-    writeToTerminal(tty_id, kernel_buf, len);
+    // block the current writing process
+    // the chars are transmitted straight from the user's pages, no kernel buffer is needed
+    len = writeToTerminal(tty_id, buf, len);
+    if (len != ERROR)
+      getCurrentProcess()->usage.tty_write_bytes += len;
     info->regs[0] = len;
     break;
   }
 
+  case YALNIX_TTY_DRAIN:
+  {
+    int tty_id = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: tty drain is called for terminal %d\n", tty_id);
+
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS)
+    {
+      TracePrintf(0, "onTrapKernel: tty drain terminal %d is invalid\n", tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    while (!isTtyDrained(tty_id))
+      sleepOn(getTtyDrainQueue(tty_id));
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_TTY_SET_MODE:
+  {
+    int tty_id = (int)info->regs[1];
+    int mode = (int)info->regs[2];
+    int min = (int)info->regs[3];
+    int timeout = (int)info->regs[4];
+    TracePrintf(2, "onTrapKernel: tty set mode is called for terminal %d with mode %d, min %d, timeout %d\n", tty_id, mode, min, timeout);
+
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS)
+    {
+      TracePrintf(0, "onTrapKernel: tty set mode terminal %d is invalid\n", tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = setTtyMode(tty_id, mode, min, timeout);
+    break;
+  }
+  case YALNIX_TTY_SET_FLAGS:
+  {
+    int tty_id = (int)info->regs[1];
+    int flags = (int)info->regs[2];
+    TracePrintf(2, "onTrapKernel: tty set flags is called for terminal %d with flags %d\n", tty_id, flags);
+
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS || (flags & ~TTY_NONBLOCK))
+    {
+      TracePrintf(0, "onTrapKernel: tty set flags %d for terminal %d is invalid\n", flags, tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct pcb *current_process = getCurrentProcess();
+    info->regs[0] = current_process->tty_flags[tty_id];
+    current_process->tty_flags[tty_id] = flags;
+    break;
+  }
+  case YALNIX_POLL:
+  {
+    struct poll_fd *fds = (struct poll_fd *)info->regs[1];
+    int n = (int)info->regs[2];
+    int timeout = (int)info->regs[3];
+    TracePrintf(2, "onTrapKernel: poll is called for %d terminals with timeout %d\n", n, timeout);
+
+    if (n < 0 || n > MAX_POLL_FDS || !validatePointer((uintptr_t)fds, n * sizeof(struct poll_fd), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: poll buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = pollTerminals(fds, n, timeout);
+    break;
+  }
+  case YALNIX_PTY_OPEN:
+  {
+    int *master = (int *)info->regs[1];
+    int *slave = (int *)info->regs[2];
+    TracePrintf(2, "onTrapKernel: pty open is called\n");
+
+    if (!validatePointer((uintptr_t)master, sizeof(int), PROT_READ | PROT_WRITE) || !validatePointer((uintptr_t)slave, sizeof(int), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: pty open buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = openPty(master, slave);
+    break;
+  }
+  case YALNIX_PTY_CLOSE:
+  {
+    int tty_id = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: pty close is called for terminal %d\n", tty_id);
+    info->regs[0] = isPty(tty_id) && mayUsePty(tty_id) ? closePty(tty_id) : ERROR;
+    break;
+  }
+  case YALNIX_PIPE_INIT:
+  {
+    int *pipe_idp = (int *)info->regs[1];
+    TracePrintf(2, "onTrapKernel: pipe init is called\n");
+
+    if (!validatePointer((uintptr_t)pipe_idp, sizeof(int), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: pipe id buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    int id = createPipe();
+    if (id == ERROR)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+    *pipe_idp = id;
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_PIPE_READ:
+  case YALNIX_PIPE_WRITE:
+  {
+    int id = (int)info->regs[1];
+    void *buf = (void *)info->regs[2];
+    int len = (int)info->regs[3];
+    int reading = info->code == YALNIX_PIPE_READ;
+    TracePrintf(2, "onTrapKernel: pipe %s is called for pipe %x with %d chars\n", reading ? "read" : "write", id, len);
+
+    if (!validatePointer((uintptr_t)buf, len, reading ? PROT_READ | PROT_WRITE : PROT_READ))
+    {
+      TracePrintf(0, "onTrapKernel: pipe buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = reading ? readPipe(id, buf, len) : writePipe(id, buf, len);
+    break;
+  }
+  case YALNIX_RECLAIM:
+  {
+    int id = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: reclaim is called for %x\n", id);
+
+    switch (OBJECT_TYPE(id))
+    {
+    case OBJECT_PIPE:
+      info->regs[0] = reclaimPipe(id);
+      break;
+    case OBJECT_LOCK:
+      info->regs[0] = reclaimLock(id);
+      break;
+    case OBJECT_CVAR:
+      info->regs[0] = reclaimCvar(id);
+      break;
+    default:
+      info->regs[0] = ERROR;
+      break;
+    }
+    break;
+  }
+  case YALNIX_REGISTER:
+  {
+    int service_id = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: register is called for service %d\n", service_id);
+    info->regs[0] = registerService(service_id);
+    break;
+  }
+  case YALNIX_SEND:
+  case YALNIX_RECEIVE:
+  case YALNIX_REPLY:
+  {
+    void *msg = (void *)info->regs[1];
+    int pid = (int)info->regs[2];
+    TracePrintf(2, "onTrapKernel: message call %d is called with pid %d\n", info->code, pid);
+
+    if (!validatePointer((uintptr_t)msg, MESSAGE_SIZE, PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: message buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    if (info->code == YALNIX_SEND)
+      info->regs[0] = sendMessage(msg, pid);
+    else if (info->code == YALNIX_RECEIVE)
+      info->regs[0] = receiveMessage(msg);
+    else
+      info->regs[0] = replyMessage(msg, pid);
+    break;
+  }
+  case YALNIX_COPY_FROM:
+  case YALNIX_COPY_TO:
+  {
+    int pid = (int)info->regs[1];
+    void *dest = (void *)info->regs[2];
+    void *src = (void *)info->regs[3];
+    int len = (int)info->regs[4];
+    int to_sender = info->code == YALNIX_COPY_TO;
+    TracePrintf(2, "onTrapKernel: copy %s is called for process %d with %d bytes\n", to_sender ? "to" : "from", pid, len);
+
+    // the buffer on our side, the one of the sender is checked page by page as it is copied
+    void *own = to_sender ? src : dest;
+    if (!validatePointer((uintptr_t)own, len, to_sender ? PROT_READ : PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: copy buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = copyMessageData(pid, dest, src, len, to_sender);
+    break;
+  }
+  case YALNIX_LOCK_INIT:
+  case YALNIX_CVAR_INIT:
+  {
+    int *idp = (int *)info->regs[1];
+    TracePrintf(2, "onTrapKernel: %s init is called\n", info->code == YALNIX_LOCK_INIT ? "lock" : "cvar");
+
+    if (!validatePointer((uintptr_t)idp, sizeof(int), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: id buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    int id = info->code == YALNIX_LOCK_INIT ? createLock() : createCvar();
+    if (id == ERROR)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+    *idp = id;
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_LOCK_ACQUIRE:
+    TracePrintf(2, "onTrapKernel: acquire is called for lock %x\n", (int)info->regs[1]);
+    info->regs[0] = acquireLock((int)info->regs[1]);
+    break;
+  case YALNIX_LOCK_RELEASE:
+    TracePrintf(2, "onTrapKernel: release is called for lock %x\n", (int)info->regs[1]);
+    info->regs[0] = releaseLock((int)info->regs[1]);
+    break;
+  case YALNIX_CVAR_WAIT:
+    TracePrintf(2, "onTrapKernel: cvar wait is called for cvar %x with lock %x\n", (int)info->regs[1], (int)info->regs[2]);
+    info->regs[0] = waitCvar((int)info->regs[1], (int)info->regs[2]);
+    break;
+  case YALNIX_CVAR_SIGNAL:
+  case YALNIX_CVAR_BROADCAST:
+    TracePrintf(2, "onTrapKernel: cvar signal is called for cvar %x\n", (int)info->regs[1]);
+    info->regs[0] = signalCvar((int)info->regs[1], info->code == YALNIX_CVAR_BROADCAST);
+    break;
+  case YALNIX_FUTEX_WAIT:
+  case YALNIX_FUTEX_WAKE:
+  {
+    int *addr = (int *)info->regs[1];
+    TracePrintf(2, "onTrapKernel: futex %s is called for word at %x\n", info->code == YALNIX_FUTEX_WAIT ? "wait" : "wake", (uintptr_t)addr);
+
+    if (((uintptr_t)addr & (sizeof(int) - 1)) || !validatePointer((uintptr_t)addr, sizeof(int), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: futex word is invalid\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    uintptr_t key = getFutexKey((uintptr_t)addr);
+    if (info->code == YALNIX_FUTEX_WAKE)
+    {
+      int count = (int)info->regs[2];
+      info->regs[0] = count > 0 ? wakeFutex(key, count) : 0;
+      break;
+    }
+
+    // nothing runs between this check and the sleep, so a wake after the user changed the word cannot be missed
+    int expected = (int)info->regs[2];
+    int timeout = (int)info->regs[3];
+    info->regs[0] = 0;
+    if (*addr != expected)
+      break;
+
+    struct wait_queue *futex_queues[2];
+    futex_queues[0] = getFutexQueue(key);
+    if (futex_queues[0] == NULL)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+    if (timeout <= 0)
+      sleepOn(futex_queues[0]);
+    else if (sleepUntil(getTickCount() + timeout, futex_queues, 1) == &timer_queue)
+      info->regs[0] = FUTEX_TIMED_OUT;
+    break;
+  }
+  case YALNIX_SET_WAKE_PREEMPT:
+  {
+    int policy = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: set wake preempt is called with policy %d\n", policy);
+
+    if (policy != WAKE_PREEMPT_NEVER && policy != WAKE_PREEMPT_PRIORITY)
+    {
+      TracePrintf(0, "onTrapKernel: wake preempt policy %d is invalid\n", policy);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = wake_preempt_policy;
+    wake_preempt_policy = policy;
+    break;
+  }
+  case YALNIX_TTY_GET_STATS:
+  {
+    int tty_id = (int)info->regs[1];
+    struct tty_stats *stats = (struct tty_stats *)info->regs[2];
+    TracePrintf(2, "onTrapKernel: tty get stats is called for terminal %d\n", tty_id);
+
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS)
+    {
+      TracePrintf(0, "onTrapKernel: tty get stats terminal %d is invalid\n", tty_id);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    if (!validatePointer((uintptr_t)stats, sizeof(struct tty_stats), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: tty stats buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    getTtyStats(tty_id, stats);
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_SET_DEADLINE:
+  {
+    int period = (int)info->regs[1];
+    int budget = (int)info->regs[2];
+    struct pcb *current_process = getCurrentProcess();
+
+    TracePrintf(2, "onTrapKernel: set deadline is called by process %d with period %d and budget %d\n", current_process->pid, period, budget);
+
+    if (setDeadline(current_process, period, budget, getTickCount()) == -1)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // move the process to the list of its new scheduling class
+    removeProcessFromList(current_process);
+    addProcessToList(current_process, EXECUTION_LIST);
+    updateNextExpiry();
+    info->regs[0] = 0;
+    break;
+  }
+
+  case YALNIX_CONTAINER_CREATE:
+  {
+    int frame_limit = (int)info->regs[1];
+    int cpu_limit = (int)info->regs[2];
+    struct pcb *current_process = getCurrentProcess();
+
+    TracePrintf(2, "onTrapKernel: container create is called by process %d with frame limit %d and cpu limit %d\n", current_process->pid, frame_limit, cpu_limit);
+
+    // only the processes in the root container may hand out limits, else a process could escape its own
+    if (current_process->container == NULL || current_process->container->id != ROOT_CONTAINER)
+    {
+      TracePrintf(0, "onTrapKernel: process %d is not in the root container\n", current_process->pid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct container *container = createContainer(frame_limit, cpu_limit);
+    if (container == NULL)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // the frames we already hold stay charged to the old container
+    joinContainer(current_process, container);
+    info->regs[0] = container->id;
+    break;
+  }
+  case YALNIX_CONTAINER_USAGE:
+  {
+    int id = (int)info->regs[1];
+    struct container_usage *usage = (struct container_usage *)info->regs[2];
+
+    TracePrintf(2, "onTrapKernel: container usage is called for container %d\n", id);
+
+    if (!validatePointer((uintptr_t)usage, sizeof(struct container_usage), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: container usage buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct container *container = id == -1 ? getCurrentProcess()->container : getContainer(id);
+    if (container == NULL)
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    usage->id = container->id;
+    usage->processes = container->process_count;
+    usage->frames = container->frames;
+    usage->frame_limit = container->frame_limit;
+    usage->cpu_ticks = container->cpu_total;
+    usage->cpu_limit = container->cpu_limit;
+    usage->throttled = container->throttled;
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_KILL:
+  {
+    int pid = (int)info->regs[1];
+    TracePrintf(2, "onTrapKernel: kill is called for %d\n", pid);
+
+    struct pcb *target = pid > IDLE_PROCESS ? getProcessByPid(pid) : NULL;
+    if (target == NULL)
+    {
+      TracePrintf(0, "onTrapKernel: kill pid %d is invalid\n", pid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct pcb *current_process = getCurrentProcess();
+    if (!mayKill(current_process, target))
+    {
+      TracePrintf(0, "onTrapKernel: process %d may not kill %d\n", current_process->pid, pid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // killing the main thread of our own process ends us too
+    if (target == current_process)
+      exitProcess(EXIT_KILLED);
+    else if (target->pid == current_process->tgid)
+    {
+      killProcess(target);
+      exitProcess(EXIT_KILLED);
+    }
+    else
+    {
+      killProcess(target);
+      info->regs[0] = 0;
+    }
+    break;
+  }
+  case YALNIX_KILL_GROUP:
+  {
+    int pgid = (int)info->regs[1];
+    struct pcb *current_process = getCurrentProcess();
+    if (pgid == 0)
+      pgid = current_process->pgid;
+
+    TracePrintf(2, "onTrapKernel: kill group is called for %d\n", pgid);
+
+    if (pgid < 0)
+    {
+      TracePrintf(0, "onTrapKernel: kill group pgid %d is invalid\n", pgid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // collect the whole group in one pass over the lists, then end them one by one
+    // the threads go with their main thread, so only the main threads are collected
+    // and only our descendants are ended, whatever group we are in
+    int max = countProcess();
+    struct pcb **targets = malloc(max * sizeof(struct pcb *));
+    int found = getProcessesByPgid(pgid, targets, max);
+    int count = 0;
+    int i;
+    for (i = 0; i < found; i++)
+      if (targets[i]->pid == targets[i]->tgid && mayKill(current_process, targets[i]))
+        targets[count++] = targets[i];
+
+    int killed = 0, kill_self = 0;
+    for (i = 0; i < count; i++)
+    {
+      if (targets[i] == current_process)
+        kill_self = 1;
+      else
+      {
+        // the main thread of our own process takes the other threads with it, but not us
+        if (targets[i]->pid == current_process->tgid)
+          kill_self = 1;
+        killProcess(targets[i]);
+        killed++;
+      }
+    }
+    free(targets);
+    TracePrintf(2, "onTrapKernel: %d processes of group %d are killed\n", killed, pgid);
+
+    if (kill_self)
+      exitProcess(EXIT_KILLED);
+    info->regs[0] = killed;
+    break;
+  }
+  case YALNIX_SET_PGID:
+  {
+    int pid = (int)info->regs[1];
+    int pgid = (int)info->regs[2];
+    struct pcb *current_process = getCurrentProcess();
+
+    TracePrintf(2, "onTrapKernel: set pgid is called for %d with %d\n", pid, pgid);
+
+    struct pcb *target = pid == 0 ? current_process : getProcessByPid(pid);
+    if (target == NULL || pgid < 0 || (target != current_process && target->ppid != current_process->tgid))
+    {
+      TracePrintf(0, "onTrapKernel: set pgid for %d is not allowed\n", pid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // a new group is named by the target itself, an existing one only joined if its leader is ours
+    // otherwise a process could slip into a foreign group, or name one after a pid not yet used
+    if (pgid == 0)
+      pgid = target->pid;
+    struct pcb *leader = pgid == target->pid ? target : getProcessByPid(pgid);
+    if (leader == NULL || leader->pgid != pgid || !isDescendant(current_process, leader))
+    {
+      TracePrintf(0, "onTrapKernel: group %d may not be joined by %d\n", pgid, target->pid);
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    target->pgid = pgid;
+    info->regs[0] = target->pgid;
+    break;
+  }
+  case YALNIX_GET_USAGE:
+  {
+    int pid = (int)info->regs[1];
+    struct process_usage *usage = (struct process_usage *)info->regs[2];
+
+    TracePrintf(2, "onTrapKernel: get usage is called for %d\n", pid);
+
+    if (!validatePointer((uintptr_t)usage, sizeof(struct process_usage), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: usage buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct pcb *target = pid == 0 ? getCurrentProcess() : getProcessByPid(pid);
+    if (target == NULL || target == getIdleProcess())
+    {
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    getProcessUsage(target, usage);
+    info->regs[0] = 0;
+    break;
+  }
+  case YALNIX_THREAD_CREATE:
+  {
+    uintptr_t fn = (uintptr_t)info->regs[1];
+    uintptr_t arg = (uintptr_t)info->regs[2];
+    uintptr_t stack = (uintptr_t)info->regs[3];
+
+    TracePrintf(2, "onTrapKernel: thread create is called for 0x%x with stack 0x%x\n", fn, stack);
+
+    // the stack grows down from stack, we put the argument and the return address on top of it
+    if (!validateAddr(fn, PROT_EXEC) || !validatePointer(stack - 2 * sizeof(uintptr_t), 2 * sizeof(uintptr_t), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: thread function or stack is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    // a thread only needs its own kernel stack, within the limit of the container
+    if (getFramesLeft() < KERNEL_STACK_PAGES)
+    {
+      TracePrintf(0, "onTrapKernel: not enough pages to allocate for thread\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    struct pcb *current_process = getCurrentProcess();
+    struct pcb *thread = createProcess();
+    if (allocateMultiPage(KERNEL_STACK_PAGES, thread->kernel_stack) == -1)
+    {
+      TracePrintf(0, "onTrapKernel: failed to allocate kernel stack for thread\n");
+      free(thread);
+      info->regs[0] = ERROR;
+      break;
+    }
+    thread->has_kernel_stack = 1;
+    // the first thread of a process, from now on the kernel stack moves with the thread
+    if (!current_process->has_kernel_stack)
+    {
+      getKernelStackPages(current_process->kernel_stack);
+      current_process->has_kernel_stack = 1;
+    }
+
+    thread->space = current_process->space;
+    thread->space->users++;
+    addProcessToList(thread, EXECUTION_LIST);
+    // a thread is no child of the creator, Wait never sees it
+    thread->ppid = current_process->ppid;
+    thread->tgid = current_process->tgid;
+    thread->pgid = current_process->pgid;
+    memcpy(thread->tty_flags, current_process->tty_flags, sizeof(thread->tty_flags));
+    joinContainer(thread, current_process->container);
+
+    // the thread may have exited before we run again, so keep its pid
+    int thread_pid = thread->pid;
+    ContextSwitch(ThreadSwitch, &current_process->ctx, current_process, thread);
+
+    if (getCurrentProcess()->pid == thread_pid)
+    {
+      // the thread calls fn(arg) on its own stack, there is nowhere to return, so it has to call ThreadExit
+      uintptr_t *sp = (uintptr_t *)stack - 2;
+      sp[0] = 0;
+      sp[1] = arg;
+      info->sp = (void *)sp;
+      info->pc = (void *)fn;
+      info->regs[0] = 0;
+    }
+    else
+      info->regs[0] = thread_pid;
+    break;
+  }
+  case YALNIX_THREAD_EXIT:
+  {
+    TracePrintf(2, "onTrapKernel: thread exit is called for %d\n", getCurrentProcess()->pid);
+    // the address space goes away with its last thread
+    exitProcess((int)info->regs[1]);
+    break;
+  }
+  case YALNIX_THREAD_JOIN:
+  {
+    int tid = (int)info->regs[1];
+    int *status = (int *)info->regs[2];
+
+    TracePrintf(2, "onTrapKernel: thread join is called for %d\n", tid);
+
+    if (!validatePointer((uintptr_t)status, sizeof(int), PROT_READ | PROT_WRITE))
+    {
+      TracePrintf(0, "onTrapKernel: thread join status buffer is invalid\n");
+      writeStrToTerminal(TTY_CONSOLE, "Invalid address\n");
+      info->regs[0] = ERROR;
+      break;
+    }
+
+    info->regs[0] = joinThread(tid, status);
+    break;
+  }
+
   default:
     TracePrintf(0, "onTrapKernel: unknown system call is called\n");
     break;
@@ -538,41 +1677,63 @@ void onTrapKernel(ExceptionInfo *info)
 void onTrapClock(ExceptionInfo *info)
 {
   AVOID_UNUSED_WARNING(info);
+  int tick_count = tickClock();
+  tickInfoPage(tick_count, getCurrentProcess() == getIdleProcess());
+
+  // idle fast path: nothing expires at this tick and the idle process has nothing else to run
+  // so we can return without touching any list
+  if (tick_count < next_expiry_tick && getCurrentProcess()->pid == IDLE_PROCESS && !hasRunnableProcess())
+    return;
+
   TracePrintf(2, "onTrapClock: clock interrupt is called\n");
-  // decrement the delay time of the process in the delay list
-  struct pcb *current_delay_process = getList(DELAY_LIST);
+  if (tick_count >= next_expiry_tick)
+    expireTimers();
 
-  // ignore the head
-  current_delay_process = current_delay_process->next;
+  struct pcb *current_process = getCurrentProcess();
+  int reschedule = 0;
 
-  while (current_delay_process->pid >= 0)
-  {
-    current_delay_process->delay--;
-    if (current_delay_process->delay <= 0)
-    {
-      // reset it just in case
-      current_delay_process->delay = 0;
-      removeProcessFromList(current_delay_process);
-      addProcessToList(current_delay_process, EXECUTION_LIST);
+  // the tick is charged to whoever was running when it ended
+  if (current_process != getIdleProcess())
+    current_process->usage.user_ticks++;
 
-      printList(DELAY_LIST);
-      printList(EXECUTION_LIST);
-    }
-    current_delay_process = current_delay_process->next;
+  // a deadline process that has used up its budget runs as a normal process until its next period
+  if (current_process->status == RT_LIST && chargeDeadlineTick(current_process))
+  {
+    TracePrintf(3, "onTrapClock: deadline process %d used up its budget\n", current_process->pid);
+    removeProcessFromList(current_process);
+    addProcessToList(current_process, EXECUTION_LIST);
+    reschedule = 1;
   }
 
+  // a process whose container has used up its cpu limit gives up the cpu until the next period
+  if (current_process != getIdleProcess() && chargeCpuTick(current_process->container, tick_count))
+    reschedule = 1;
+
+  // a deadline process with an earlier deadline does not wait for the quantum to end
+  struct pcb *first_deadline_process = getList(RT_LIST)->next;
+  if (first_deadline_process->pid >= 0 && first_deadline_process != current_process)
+    reschedule = 1;
+
+  // the idle process gives way as soon as anyone is runnable
+  if (current_process == getIdleProcess())
+    reschedule = 1;
+
   clock_ticks++;
-  if (clock_ticks == CLOCK_INTERVAL)
+  if (clock_ticks == CLOCK_INTERVAL || reschedule)
   {
-    clock_ticks = 0;
-    struct pcb *current_process = getCurrentProcess();
     struct pcb *next_process = getNextProcess(1);
 
+    // the current process has used up a whole quantum, it is less interactive than we thought
+    if (clock_ticks == CLOCK_INTERVAL && current_process->priority > 0)
+      current_process->priority--;
+    clock_ticks = 0;
+
     TracePrintf(2, "onTrapClock: clock interrupt is called, current process is %d, next process is %d\n", current_process->pid, next_process->pid);
 
     // if the next process is not the current process, we will do the context switch
+    // the next process is the idle process when everyone else (the current process included) is throttled
     if (next_process != current_process)
-      ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
+      switchProcess(current_process, next_process);
   }
 }
 
@@ -589,8 +1750,9 @@ void onTrapMemory(ExceptionInfo *info)
 {
   TracePrintf(2, "onTrapMemory: memory exception is called\n");
   struct pcb *current_process = getCurrentProcess();
+  current_process->usage.page_faults++;
 
-  uintptr_t valid_stack_pointer = current_process->stk;
+  uintptr_t valid_stack_pointer = current_process->space->stk;
 
   TracePrintf(2, "accessing memory at 0x%x, while current stack is ar 0x%x\n", info->addr, valid_stack_pointer);
 
@@ -617,7 +1779,7 @@ void onTrapMemory(ExceptionInfo *info)
   uintptr_t next_stk = (uintptr_t)DOWN_TO_PAGE(addr);
 
   // if the actual being allocated address is in red zone, terminate the process
-  if (next_stk < getCurrentProcess()->brk + PAGESIZE)
+  if (next_stk < getCurrentProcess()->space->brk + PAGESIZE)
   {
     TracePrintf(0, "Fail to allocate new page: not enough virtual memory\n");
     writeStrToTerminal(TTY_CONSOLE, "Segmentation fault\n");
@@ -649,7 +1811,7 @@ void onTrapMemory(ExceptionInfo *info)
 
   // current_process->sp = (void *)addr;
   // update the sp and stk pointer
-  current_process->stk = next_stk;
+  current_process->space->stk = next_stk;
   // TracePrintf(0, "update process sp at 0x%x\n", addr);
   TracePrintf(0, "update process stk at 0x%x\n", next_stk);
 }
@@ -668,53 +1830,12 @@ void onTrapTTYReceive(ExceptionInfo *info)
 
   int tty_id = info->code;
 
-  tty_buf *tty_receive_buf = getTtyReceiveBuf(tty_id);
-
-  void *buf = malloc(TERMINAL_MAX_LINE);
-  int str_len = TtyReceive(tty_id, buf, TERMINAL_MAX_LINE);
+  receiveTtyLine(tty_id);
+  wakeAll(getTtyPollQueue(tty_id));
 
-  int len = addBuf(tty_receive_buf, buf, str_len);
-  TracePrintf(3, "added %d out of %d chars to tty_receive_buf, tty_receive_buf size: %d\n", len, str_len, tty_receive_buf->size);
-  free(buf);
-
-  struct pcb *tty_read_process = getList(TTY_READ_LIST);
-  struct pcb *next_read_process = NULL;
-  tty_read_process = tty_read_process->next;
-  while (tty_read_process->pid != -1)
-  {
-    if (tty_read_process->tty_read_id == tty_id)
-    {
-      next_read_process = tty_read_process;
-      break;
-    }
-    tty_read_process = tty_read_process->next;
-  }
-
-  // struct pcb *next_read_process = getList(TTY_READ_LIST);
-  // next_read_process = next_read_process->next;
-  // while (next_read_process->tty_read_id != tty_id)
-  // {
-  //   next_read_process = next_read_process->next;
-  // }
-
-  if (next_read_process == NULL)
-    return;
-
-  TracePrintf(3, "next pending reading process with pid=%d\n", next_read_process->pid);
-  // unblock the next process that wants to read, but not neccessarily at once
-  removeProcessFromList(next_read_process);
-
-  addProcessToList(next_read_process, EXECUTION_LIST);
-  TracePrintf(3, "added the pending reading process to the execution list\n");
-
-  // // if the current process is idle process, switch to the reading process at once
-  // struct pcb *current_process = getCurrentProcess();
-  // if (current_process->pid == 0)
-  // {
-  //   TracePrintf(3, "idle process detacted, switch now\n");
-  //   ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_read_process);
-  // }
+  // unblock the next process that wants to read, it may run at once depending on wake_preempt_policy
   // if there is no reading process pending, do nothing as we already save the line
+  wakeUpForIo(getTtyReadQueue(tty_id));
 }
 
 void onTrapTTYTransmit(ExceptionInfo *info)
@@ -723,32 +1844,16 @@ void onTrapTTYTransmit(ExceptionInfo *info)
 
   int tty_id = info->code;
 
-  setTerminalTransmitStatus(tty_id, IDLE);
-
-  struct pcb *tty_write_process = getList(TTY_WRITE_LIST);
-  struct pcb *next_write_process = NULL;
-  printList(TTY_WRITE_LIST);
-  tty_write_process = tty_write_process->next;
-  while (tty_write_process->pid != -1)
-  {
-    if (tty_write_process->tty_write_id == tty_id)
-    {
-      next_write_process = tty_write_process;
-      break;
-    }
-    tty_write_process = tty_write_process->next;
-  }
-
-  // we have no candidate, we just exit
-  if (next_write_process == NULL)
-    return;
+  // the next line of the transmit ring goes out at once
+  finishTtyTransmit(tty_id);
 
-  TracePrintf(3, "next pending reading process with pid=%d\n", next_write_process->pid);
-  // unblock the next process that wants to read, but not neccessarily at once
-  removeProcessFromList(next_write_process);
+  if (isTtyDrained(tty_id))
+    wakeAll(getTtyDrainQueue(tty_id));
+  wakeAll(getTtyPollQueue(tty_id));
 
-  addProcessToList(next_write_process, EXECUTION_LIST);
-  TracePrintf(3, "added the pending reading process to the execution list\n");
+  // unblock the writer of the terminal, it may run at once depending on wake_preempt_policy
+  // the other writers wait for it to hand the terminal over, so they cost nothing here
+  wakeUpForIo(getTtyTransmitQueue(tty_id));
   // tty_buf *tty_transmit_buf = getTtyTransmitBuf(tty_id);
 
   // // always trying to read the maximum of chars
@@ -27,4 +27,7 @@ void onTrapTTYReceive(ExceptionInfo *info);
 // trap for terminal transmit
 void onTrapTTYTransmit(ExceptionInfo *info);
 
+// initialize the timer queue for Delay and the timed waits
+void initTimers();
+
 #endif // YALNIX_HANDLER_H
@@ -0,0 +1,49 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <string.h>
+#include "info_page.h"
+#include "page.h"
+#include "pte.h"
+
+static uintptr_t info_page = 0;
+// the kernel's own view of the page
+static struct kernel_info *info = (struct kernel_info *)KERNEL_INFO_WINDOW_VADDR;
+
+void initInfoPage()
+{
+  // the page is shared by everyone, so no container pays for it
+  info_page = allocateKernelPage();
+  if (info_page == (uintptr_t)-1)
+  {
+    TracePrintf(0, "initInfoPage: failed to allocate the info page\n");
+    Halt();
+  }
+  writePageTableEntry(getPageTable1(), KERNEL_INFO_WINDOW_VADDR, info_page, PROT_READ | PROT_WRITE, PROT_NONE);
+  WriteRegister(REG_TLB_FLUSH, KERNEL_INFO_WINDOW_VADDR);
+  memset(info, 0, PAGESIZE);
+  TracePrintf(3, "initInfoPage: info page is at physical address 0x%x\n", info_page);
+}
+
+void mapInfoPage(struct pte *page_table)
+{
+  writePageTableEntry(page_table, KERNEL_INFO_VADDR, info_page, PROT_READ, PROT_READ);
+}
+
+void dispatchInfoPage(struct pcb *pcb)
+{
+  if (info->pid != pcb->pid)
+    info->context_switches++;
+  info->pid = pcb->pid;
+  info->ppid = pcb->ppid;
+  info->processes = countProcess();
+  info->seq++;
+}
+
+void tickInfoPage(int ticks, int idle)
+{
+  info->ticks = ticks;
+  if (idle)
+    info->idle_ticks++;
+  info->processes = countProcess();
+  info->seq++;
+}
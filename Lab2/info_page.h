@@ -0,0 +1,21 @@
+#ifndef YALNIX_INFO_PAGE_H
+#define YALNIX_INFO_PAGE_H
+#include "pcb.h"
+#include "kinfo.h"
+// this file keeps the kernel info page (see kinfo.h) up to date
+// one physical page is shared by every region 0, the kernel writes it through a window of its own in region 1
+// since a single process runs at a time, the page always describes the running one
+
+// allocate the info page and map its window, call after the virtual memory is enabled
+void initInfoPage();
+
+// map the info page read-only into the region 0 page table (a virtual address the kernel can write)
+void mapInfoPage(struct pte *page_table);
+
+// the process is being dispatched
+void dispatchInfoPage(struct pcb *pcb);
+
+// a clock tick has passed, idle is set if it found nothing to run
+void tickInfoPage(int ticks, int idle);
+
+#endif // YALNIX_INFO_PAGE_H
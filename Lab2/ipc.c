@@ -0,0 +1,194 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ipc.h"
+#include "pcb.h"
+#include "pte.h"
+#include "wait_queue.h"
+
+// the pid of the server of each service, 0 if none
+static int services[MAX_SERVICES];
+
+void initIpc()
+{
+  memset(services, 0, sizeof(services));
+}
+
+int registerService(int service_id)
+{
+  if (service_id <= 0 || service_id >= MAX_SERVICES)
+    return ERROR;
+  // a service is free again once its server has exited
+  if (services[service_id] != 0 && getProcessByPid(services[service_id]) != NULL)
+    return ERROR;
+  services[service_id] = getCurrentProcess()->pid;
+  return 0;
+}
+
+// append the sender to the senders waiting for the receiver
+static void queueSender(struct pcb *receiver, struct pcb *sender)
+{
+  sender->msg_next = NULL;
+  if (receiver->msg_senders == NULL)
+    receiver->msg_senders = sender;
+  else
+    receiver->msg_senders_tail->msg_next = sender;
+  receiver->msg_senders_tail = sender;
+}
+
+// take the sender out of the senders waiting for the receiver
+static void unqueueSender(struct pcb *receiver, struct pcb *sender)
+{
+  struct pcb *prev = NULL;
+  struct pcb *current = receiver->msg_senders;
+  while (current != NULL && current != sender)
+  {
+    prev = current;
+    current = current->msg_next;
+  }
+  if (current == NULL)
+    return;
+
+  if (prev == NULL)
+    receiver->msg_senders = sender->msg_next;
+  else
+    prev->msg_next = sender->msg_next;
+  if (receiver->msg_senders_tail == sender)
+    receiver->msg_senders_tail = prev;
+}
+
+int sendMessage(void *msg, int pid)
+{
+  struct pcb *current_process = getCurrentProcess();
+  if (pid < 0)
+    pid = -pid < MAX_SERVICES ? services[-pid] : 0;
+
+  struct pcb *receiver = getProcessByPid(pid);
+  if (pid <= 0 || receiver == NULL || receiver == current_process)
+    return ERROR;
+
+  current_process->msg = msg;
+  current_process->msg_peer = receiver->pid;
+  current_process->msg_result = 0;
+
+  if (receiver->msg_state == MSG_RECEIVE_WAIT)
+  {
+    // hand the message over and run the receiver at once, it is the one we are waiting for
+    if (copyAddressSpace(receiver->space->page_table, (uintptr_t)receiver->msg, msg, MESSAGE_SIZE, 1) == -1)
+      return ERROR;
+    receiver->msg_peer = current_process->pid;
+    receiver->msg_state = MSG_NONE;
+    current_process->msg_state = MSG_REPLY_WAIT;
+    wakeOne(&receiver->msg_wait);
+    struct wait_queue *queue = &current_process->msg_wait;
+    sleepOnAndRun(&queue, 1, receiver);
+  }
+  else
+  {
+    current_process->msg_state = MSG_SEND_WAIT;
+    queueSender(receiver, current_process);
+    sleepOn(&current_process->msg_wait);
+  }
+
+  return current_process->msg_result;
+}
+
+int receiveMessage(void *msg)
+{
+  struct pcb *current_process = getCurrentProcess();
+  while (current_process->msg_senders == NULL)
+  {
+    current_process->msg = msg;
+    current_process->msg_state = MSG_RECEIVE_WAIT;
+    sleepOn(&current_process->msg_wait);
+    // a sender has put its message into msg already
+    if (current_process->msg_state == MSG_NONE)
+      return current_process->msg_peer;
+    // else the sender is to be copied from below, into a buffer another thread may have freed meanwhile
+    if (!isUserBuffer((uintptr_t)msg, MESSAGE_SIZE, PROT_READ | PROT_WRITE))
+    {
+      current_process->msg_state = MSG_NONE;
+      return ERROR;
+    }
+  }
+
+  struct pcb *sender = current_process->msg_senders;
+  unqueueSender(current_process, sender);
+  if (copyAddressSpace(sender->space->page_table, (uintptr_t)sender->msg, msg, MESSAGE_SIZE, 0) == -1)
+  {
+    sender->msg_state = MSG_NONE;
+    sender->msg_result = ERROR;
+    wakeOne(&sender->msg_wait);
+    return ERROR;
+  }
+  sender->msg_state = MSG_REPLY_WAIT;
+  return sender->pid;
+}
+
+// get the sender with the pid if it is waiting for a reply from the current process
+static struct pcb *getReplyWaiter(int pid)
+{
+  struct pcb *sender = getProcessByPid(pid);
+  if (sender == NULL || sender->msg_state != MSG_REPLY_WAIT || sender->msg_peer != getCurrentProcess()->pid)
+    return NULL;
+  return sender;
+}
+
+int replyMessage(void *msg, int pid)
+{
+  struct pcb *sender = getReplyWaiter(pid);
+  if (sender == NULL)
+    return ERROR;
+
+  // the sender is released either way, a reply it cannot get makes its Send fail
+  int result = copyAddressSpace(sender->space->page_table, (uintptr_t)sender->msg, msg, MESSAGE_SIZE, 1) == -1 ? ERROR : 0;
+  sender->msg_state = MSG_NONE;
+  sender->msg_result = result;
+  wakeOne(&sender->msg_wait);
+  return result;
+}
+
+int copyMessageData(int pid, void *dest, void *src, int len, int to_sender)
+{
+  struct pcb *sender = getReplyWaiter(pid);
+  if (sender == NULL)
+    return ERROR;
+
+  if (to_sender)
+    return copyAddressSpace(sender->space->page_table, (uintptr_t)dest, src, len, 1) == -1 ? ERROR : 0;
+  return copyAddressSpace(sender->space->page_table, (uintptr_t)src, dest, len, 0) == -1 ? ERROR : 0;
+}
+
+// find a process blocked in an exchange with the pcb
+static struct pcb *findPeer(struct pcb *pcb)
+{
+  struct pcb *current = getList(BLOCKED_LIST)->next;
+  for (; current != NULL && current->next != NULL; current = current->next)
+    if ((current->msg_state == MSG_SEND_WAIT || current->msg_state == MSG_REPLY_WAIT) && current->msg_peer == pcb->pid)
+      return current;
+  return NULL;
+}
+
+void dropMessages(struct pcb *pcb)
+{
+  // a sender that is going away leaves the queue of its receiver
+  if (pcb->msg_state == MSG_SEND_WAIT)
+  {
+    struct pcb *receiver = getProcessByPid(pcb->msg_peer);
+    if (receiver != NULL)
+      unqueueSender(receiver, pcb);
+  }
+  pcb->msg_state = MSG_NONE;
+
+  // the ones sending to it will never get a reply
+  pcb->msg_senders = NULL;
+  pcb->msg_senders_tail = NULL;
+  struct pcb *peer;
+  while ((peer = findPeer(pcb)) != NULL)
+  {
+    peer->msg_state = MSG_NONE;
+    peer->msg_result = ERROR;
+    wakeOne(&peer->msg_wait);
+  }
+}
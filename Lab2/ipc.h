@@ -0,0 +1,48 @@
+#ifndef YALNIX_IPC_H
+#define YALNIX_IPC_H
+#include "pcb.h"
+// this file manages the message passing between processes
+// a message goes straight from the user memory of the sender to the one of the receiver, nothing is buffered
+// the sender stays blocked until the receiver replies, meanwhile the receiver may copy from and to its memory
+
+// what a process is doing in the message passing
+enum MessageState
+{
+  MSG_NONE,
+  MSG_SEND_WAIT,    // sent, waiting for the receiver to receive
+  MSG_REPLY_WAIT,   // received, waiting for the receiver to reply
+  MSG_RECEIVE_WAIT, // waiting for a sender
+};
+
+// the most services that can be registered, the service ids go from 1 to MAX_SERVICES - 1
+#define MAX_SERVICES 16
+
+// initialize the table of services
+void initIpc();
+
+// register the current process as the server of the service, return ERROR if it is taken
+int registerService(int service_id);
+
+// send the message to the process with the pid, or to the server of the service -pid if it is negative
+// block until the receiver replies, the reply overwrites the message
+// return 0, or ERROR if there is no such receiver or it exits before replying
+int sendMessage(void *msg, int pid);
+
+// wait for the next message and copy it into msg, the senders are received in the order they sent
+// return the pid of the sender
+int receiveMessage(void *msg);
+
+// copy the reply into the message of the sender with the pid, and let it go
+// return ERROR if the process is not waiting for a reply from the current process
+// or the reply cannot be copied, then the sender is let go and its Send returns ERROR
+int replyMessage(void *msg, int pid);
+
+// copy len bytes between the current process and the sender with the pid, while it waits for the reply
+// from src of the sender into dest if to_sender is 0, from src into dest of the sender otherwise
+// return ERROR if the process is not waiting for a reply from the current process, or the buffer is invalid
+int copyMessageData(int pid, void *dest, void *src, int len, int to_sender);
+
+// fail every exchange of the exiting process, the processes waiting on it get ERROR
+void dropMessages(struct pcb *pcb);
+
+#endif // YALNIX_IPC_H
@@ -0,0 +1,226 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include "kernel_call.h"
+// this file is the user side of the kernel calls in kernel_call.h
+// each call traps into the kernel, where onTrapKernel finds the code in info->code,
+// the arguments in info->regs[1] onwards, and leaves the result in info->regs[0]
+// the calls that yalnix.h already has come from the course library instead
+
+// trap into the kernel with the call code and up to five arguments, return info->regs[0]
+// the hardware takes the code from %eax and regs[1] to regs[5] from %ebx, %ecx, %edx, %esi and %edi
+// and hands regs[0] back in %eax, the same way as the stubs of the course library
+static int trapKernel(int code, unsigned long arg1, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned long arg5)
+{
+  int result;
+  __asm__ volatile("int $0x80"
+                   : "=a"(result)
+                   : "a"(code), "b"(arg1), "c"(arg2), "d"(arg3), "S"(arg4), "D"(arg5)
+                   : "memory");
+  return result;
+}
+
+#define KERNEL_CALL_0(code) trapKernel(code, 0, 0, 0, 0, 0)
+#define KERNEL_CALL_1(code, a) trapKernel(code, (unsigned long)(a), 0, 0, 0, 0)
+#define KERNEL_CALL_2(code, a, b) trapKernel(code, (unsigned long)(a), (unsigned long)(b), 0, 0, 0)
+#define KERNEL_CALL_3(code, a, b, c) trapKernel(code, (unsigned long)(a), (unsigned long)(b), (unsigned long)(c), 0, 0)
+#define KERNEL_CALL_4(code, a, b, c, d) trapKernel(code, (unsigned long)(a), (unsigned long)(b), (unsigned long)(c), (unsigned long)(d), 0)
+#define KERNEL_CALL_5(code, a, b, c, d, e) trapKernel(code, (unsigned long)(a), (unsigned long)(b), (unsigned long)(c), (unsigned long)(d), (unsigned long)(e))
+
+int WaitPid(int pid, int *status, int options, int timeout, struct process_usage *usage)
+{
+  return KERNEL_CALL_5(YALNIX_WAITPID, pid, status, options, timeout, usage);
+}
+
+int SetDeadline(int period, int budget)
+{
+  return KERNEL_CALL_2(YALNIX_SET_DEADLINE, period, budget);
+}
+
+int ContainerCreate(int frame_limit, int cpu_limit)
+{
+  return KERNEL_CALL_2(YALNIX_CONTAINER_CREATE, frame_limit, cpu_limit);
+}
+
+int ContainerUsage(int id, struct container_usage *usage)
+{
+  return KERNEL_CALL_2(YALNIX_CONTAINER_USAGE, id, usage);
+}
+
+int ThreadCreate(void (*fn)(void *), void *arg, void *stack)
+{
+  return KERNEL_CALL_3(YALNIX_THREAD_CREATE, fn, arg, stack);
+}
+
+void ThreadExit(int status)
+{
+  KERNEL_CALL_1(YALNIX_THREAD_EXIT, status);
+  // the kernel never comes back here
+  while (1)
+    ;
+}
+
+int ThreadJoin(int tid, int *status)
+{
+  return KERNEL_CALL_2(YALNIX_THREAD_JOIN, tid, status);
+}
+
+int Kill(int pid)
+{
+  return KERNEL_CALL_1(YALNIX_KILL, pid);
+}
+
+int KillGroup(int pgid)
+{
+  return KERNEL_CALL_1(YALNIX_KILL_GROUP, pgid);
+}
+
+int SetPgid(int pid, int pgid)
+{
+  return KERNEL_CALL_2(YALNIX_SET_PGID, pid, pgid);
+}
+
+int GetUsage(int pid, struct process_usage *usage)
+{
+  return KERNEL_CALL_2(YALNIX_GET_USAGE, pid, usage);
+}
+
+int TtyDrain(int tty_id)
+{
+  return KERNEL_CALL_1(YALNIX_TTY_DRAIN, tty_id);
+}
+
+int TtyGetStats(int tty_id, struct tty_stats *stats)
+{
+  return KERNEL_CALL_2(YALNIX_TTY_GET_STATS, tty_id, stats);
+}
+
+int TtySetMode(int tty_id, int mode, int min, int timeout)
+{
+  return KERNEL_CALL_4(YALNIX_TTY_SET_MODE, tty_id, mode, min, timeout);
+}
+
+int TtySetFlags(int tty_id, int flags)
+{
+  return KERNEL_CALL_2(YALNIX_TTY_SET_FLAGS, tty_id, flags);
+}
+
+int Poll(struct poll_fd *fds, int n, int timeout)
+{
+  return KERNEL_CALL_3(YALNIX_POLL, fds, n, timeout);
+}
+
+int PtyOpen(int *master, int *slave)
+{
+  return KERNEL_CALL_2(YALNIX_PTY_OPEN, master, slave);
+}
+
+int PtyClose(int tty_id)
+{
+  return KERNEL_CALL_1(YALNIX_PTY_CLOSE, tty_id);
+}
+
+#ifdef KERNEL_CALL_DECLARES_PIPES
+int PipeInit(int *pipe_idp)
+{
+  return KERNEL_CALL_1(YALNIX_PIPE_INIT, pipe_idp);
+}
+
+int PipeRead(int pipe_id, void *buf, int len)
+{
+  return KERNEL_CALL_3(YALNIX_PIPE_READ, pipe_id, buf, len);
+}
+
+int PipeWrite(int pipe_id, void *buf, int len)
+{
+  return KERNEL_CALL_3(YALNIX_PIPE_WRITE, pipe_id, buf, len);
+}
+
+int Reclaim(int id)
+{
+  return KERNEL_CALL_1(YALNIX_RECLAIM, id);
+}
+#endif
+
+#ifdef KERNEL_CALL_DECLARES_LOCKS
+int LockInit(int *lock_idp)
+{
+  return KERNEL_CALL_1(YALNIX_LOCK_INIT, lock_idp);
+}
+
+int Acquire(int lock_id)
+{
+  return KERNEL_CALL_1(YALNIX_LOCK_ACQUIRE, lock_id);
+}
+
+int Release(int lock_id)
+{
+  return KERNEL_CALL_1(YALNIX_LOCK_RELEASE, lock_id);
+}
+
+int CvarInit(int *cvar_idp)
+{
+  return KERNEL_CALL_1(YALNIX_CVAR_INIT, cvar_idp);
+}
+
+int CvarWait(int cvar_id, int lock_id)
+{
+  return KERNEL_CALL_2(YALNIX_CVAR_WAIT, cvar_id, lock_id);
+}
+
+int CvarSignal(int cvar_id)
+{
+  return KERNEL_CALL_1(YALNIX_CVAR_SIGNAL, cvar_id);
+}
+
+int CvarBroadcast(int cvar_id)
+{
+  return KERNEL_CALL_1(YALNIX_CVAR_BROADCAST, cvar_id);
+}
+#endif
+
+int FutexWait(int *addr, int expected, int timeout)
+{
+  return KERNEL_CALL_3(YALNIX_FUTEX_WAIT, addr, expected, timeout);
+}
+
+int FutexWake(int *addr, int count)
+{
+  return KERNEL_CALL_2(YALNIX_FUTEX_WAKE, addr, count);
+}
+
+int SetWakePreempt(int policy)
+{
+  return KERNEL_CALL_1(YALNIX_SET_WAKE_PREEMPT, policy);
+}
+
+#ifdef KERNEL_CALL_DECLARES_IPC
+int Register(unsigned int service_id)
+{
+  return KERNEL_CALL_1(YALNIX_REGISTER, service_id);
+}
+
+int Send(void *msg, int pid)
+{
+  return KERNEL_CALL_2(YALNIX_SEND, msg, pid);
+}
+
+int Receive(void *msg)
+{
+  return KERNEL_CALL_1(YALNIX_RECEIVE, msg);
+}
+
+int Reply(void *msg, int pid)
+{
+  return KERNEL_CALL_2(YALNIX_REPLY, msg, pid);
+}
+
+int CopyFrom(int srcpid, void *dest, void *src, int len)
+{
+  return KERNEL_CALL_4(YALNIX_COPY_FROM, srcpid, dest, src, len);
+}
+
+int CopyTo(int destpid, void *dest, void *src, int len)
+{
+  return KERNEL_CALL_4(YALNIX_COPY_TO, destpid, dest, src, len);
+}
+#endif
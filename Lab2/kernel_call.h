@@ -0,0 +1,312 @@
+#ifndef YALNIX_KERNEL_CALL_H
+#define YALNIX_KERNEL_CALL_H
+#include <comp421/yalnix.h>
+// this file stores the kernel calls we provide on top of the ones in yalnix.h
+// the call codes are shared by the kernel (onTrapKernel) and the user programs
+// the user programs link with kernel_call.a (kernel_call.c) to make these calls
+
+#define YALNIX_WAITPID 51
+#define YALNIX_SET_DEADLINE 52
+#define YALNIX_CONTAINER_CREATE 53
+#define YALNIX_CONTAINER_USAGE 54
+#define YALNIX_THREAD_CREATE 55
+#define YALNIX_THREAD_EXIT 56
+#define YALNIX_THREAD_JOIN 57
+#define YALNIX_KILL 58
+#define YALNIX_KILL_GROUP 59
+#define YALNIX_SET_PGID 60
+#define YALNIX_GET_USAGE 61
+#define YALNIX_TTY_DRAIN 62
+#define YALNIX_TTY_GET_STATS 63
+#define YALNIX_TTY_SET_MODE 64
+#define YALNIX_TTY_SET_FLAGS 65
+#define YALNIX_POLL 66
+#define YALNIX_PTY_OPEN 67
+#define YALNIX_PTY_CLOSE 68
+
+// the pipe calls keep the codes of yalnix.h if it has them
+#ifndef YALNIX_PIPE_INIT
+#define KERNEL_CALL_DECLARES_PIPES
+#define YALNIX_PIPE_INIT 69
+#define YALNIX_PIPE_READ 70
+#define YALNIX_PIPE_WRITE 71
+#define YALNIX_RECLAIM 72
+#endif
+
+// the lock and condition variable calls, with the codes of yalnix.h if it has them
+#ifndef YALNIX_LOCK_INIT
+#define KERNEL_CALL_DECLARES_LOCKS
+#define YALNIX_LOCK_INIT 79
+#define YALNIX_LOCK_ACQUIRE 80
+#define YALNIX_LOCK_RELEASE 81
+#define YALNIX_CVAR_INIT 82
+#define YALNIX_CVAR_SIGNAL 83
+#define YALNIX_CVAR_BROADCAST 84
+#define YALNIX_CVAR_WAIT 85
+#endif
+
+#define YALNIX_FUTEX_WAIT 86
+#define YALNIX_FUTEX_WAKE 87
+
+// FutexWait returns this when the timeout runs out before a FutexWake
+#define FUTEX_TIMED_OUT -2
+
+#define YALNIX_SET_WAKE_PREEMPT 88
+
+// what a process woken up by terminal I/O does to the current process, set by SetWakePreempt
+#define WAKE_PREEMPT_NEVER 0    // it waits for its turn in the execution list
+#define WAKE_PREEMPT_PRIORITY 1 // it runs at once if its dynamic priority is higher than the current process's, the default
+
+// the message passing calls of the file server lab, yalnix.h declares them itself if it has them
+#ifndef YALNIX_SEND
+#define KERNEL_CALL_DECLARES_IPC
+#define YALNIX_REGISTER 73
+#define YALNIX_SEND 74
+#define YALNIX_RECEIVE 75
+#define YALNIX_REPLY 76
+#define YALNIX_COPY_FROM 77
+#define YALNIX_COPY_TO 78
+#endif
+
+// the size of every message of Send, Receive and Reply
+#ifndef MESSAGE_SIZE
+#define MESSAGE_SIZE 32
+#endif
+
+// options for WaitPid
+#define WNOHANG 1
+
+// the modes of TtySetMode
+#define TTY_MODE_CANONICAL 0 // the kernel edits the input and TtyRead returns a line at a time, the default
+#define TTY_MODE_RAW 1       // TtyRead returns the chars as they arrive, with no editing
+
+// the chars the kernel handles in canonical mode
+#define TTY_ERASE_CHAR '\b'   // delete the char before it
+#define TTY_DELETE_CHAR '\177' // the same as TTY_ERASE_CHAR
+#define TTY_KILL_CHAR '\025'   // ^U, delete the line so far
+#define TTY_EOF_CHAR '\004'    // ^D, end the line without a newline, alone it makes TtyRead return 0
+
+// the flags of TtySetFlags
+#define TTY_NONBLOCK 1 // TtyRead and TtyWrite return TTY_WOULD_BLOCK instead of blocking
+
+// what TtyRead and TtyWrite return on a TTY_NONBLOCK terminal that is not ready
+#define TTY_WOULD_BLOCK -2
+
+// the events of Poll
+#define POLL_READ 1  // TtyRead would not block
+#define POLL_WRITE 2 // TtyWrite would take at least one char without blocking
+
+// the most terminals a Poll may ask about
+#define MAX_POLL_FDS 16
+
+// a terminal to watch with Poll, the kernel fills revents with the events that are ready
+struct poll_fd
+{
+  int tty_id;
+  int events;
+  int revents;
+};
+
+// the exit status a parent collects for a child ended by Kill or KillGroup
+#define EXIT_KILLED -9
+
+// the usage of a resource container, filled by ContainerUsage
+struct container_usage
+{
+  int id;
+  int processes;   // the number of processes in the container
+  int frames;      // the physical frames charged to the container
+  int frame_limit; // 0 means no limit
+  int cpu_ticks;   // the clock ticks the container has run in total
+  int cpu_limit;   // the clock ticks the container may run every CONTAINER_CPU_PERIOD ticks, 0 means no limit
+  int throttled;   // the number of periods the container has hit its cpu limit
+};
+
+// the resource usage of a process, filled by GetUsage and WaitPid
+// the ticks are clock ticks, the blocked ones are split by what the process waited for
+struct process_usage
+{
+  int user_ticks;           // running on the cpu
+  int runnable_ticks;       // ready to run, but another process had the cpu
+  int delay_ticks;          // blocked in Delay
+  int wait_ticks;           // blocked waiting for a child
+  int tty_read_ticks;       // blocked reading a terminal
+  int tty_write_ticks;      // blocked writing a terminal
+  int voluntary_switches;   // gave up the cpu by blocking
+  int involuntary_switches; // preempted while still runnable
+  int page_faults;          // memory traps, the ones that grow the stack included
+  int brk_pages;            // pages added to the heap by Brk
+  int tty_read_bytes;
+  int tty_write_bytes;
+  int rt_periods;           // periods ended in the deadline class
+  int rt_misses;            // of those, the ones that ended before the budget was served
+};
+
+// the counters of a terminal since boot, filled by TtyGetStats
+struct tty_stats
+{
+  int received_lines;
+  int received_bytes;
+  int staged_lines;   // the received lines copied through the staging line as the ring had no contiguous room
+  int unread_bytes;   // the chars waiting in the receive ring
+  int overruns;       // the received lines that did not fit in the receive ring
+  int dropped_lines;  // the whole lines thrown away to handle the overruns
+  int dropped_bytes;  // every char lost to the overruns
+  int writes;         // the TtyWrite calls that went through the transmit ring
+  int transmits;      // the TtyTransmit calls for those writes, fewer when lines are coalesced
+  int transmit_bytes;
+};
+
+// wait for the child with the given pid to exit, pid -1 means any child
+// with WNOHANG, return 0 at once if no such child has exited yet
+// if timeout is positive, return 0 after that many clock ticks without an exit
+// otherwise return the pid of the child and store its exit status in status
+// and its final resource usage in usage, unless usage is NULL
+int WaitPid(int pid, int *status, int options, int timeout, struct process_usage *usage);
+
+// put the calling process into the earliest-deadline-first class, so it may run budget ticks
+// in every period ticks before any normal process, a period of 0 makes it a normal process again
+// return ERROR if the total utilization (budget / period) of the deadline processes would go above 1
+int SetDeadline(int period, int budget);
+
+// create a resource container and move the calling process into it, its future children inherit it
+// frame_limit caps the physical frames and cpu_limit caps the clock ticks per CONTAINER_CPU_PERIOD, 0 means no limit
+// only a process in the root container may create one, return the id of the container or ERROR
+int ContainerCreate(int frame_limit, int cpu_limit);
+
+// get the usage of the container with the id, -1 means the container of the calling process
+int ContainerUsage(int id, struct container_usage *usage);
+
+// start a thread that runs fn(arg) on the stack, which points to the top of its memory
+// the thread shares the address space of the calling process, but has its own kernel stack
+// fn must not return, the thread ends with ThreadExit, return the id of the thread or ERROR
+// a thread is not a child, Wait and WaitPid never return it
+int ThreadCreate(void (*fn)(void *), void *arg, void *stack);
+
+// end the calling thread, Exit in a thread does the same
+// the process ends with its main thread, whose Exit (or ThreadExit) ends the other threads too
+void ThreadExit(int status);
+
+// wait for the thread with the id to exit and store its exit status in status
+// any thread of the process may join any other, except the main thread
+int ThreadJoin(int tid, int *status);
+
+// end the process with the pid wherever it is blocked, its parent collects EXIT_KILLED as the exit status
+// only the caller's own threads and its descendants may be killed, init never
+// return 0, or ERROR if there is no such process or it may not be killed
+int Kill(int pid);
+
+// end every process of the group, 0 means the group of the calling process
+// only the descendants of the caller are ended, even in the caller's own group
+// the caller ends last if it is in the group, else return the number of processes ended
+int KillGroup(int pgid);
+
+// move the process with the pid (0 for the caller) into the group pgid (0 for a new group named by the pid)
+// only the caller itself or one of its children can be moved, and only into a new group or one
+// whose leader is the caller or a descendant of it, return the group id or ERROR
+int SetPgid(int pid, int pgid);
+
+// get the resource usage of the process with the pid so far, 0 means the calling process
+int GetUsage(int pid, struct process_usage *usage);
+
+// TtyWrite returns once the chars are queued for the terminal, wait here until they are all transmitted
+int TtyDrain(int tty_id);
+
+// get the counters of the terminal, return ERROR if there is no such terminal
+int TtyGetStats(int tty_id, struct tty_stats *stats);
+
+// select how TtyRead delivers the input of the terminal from now on
+// in TTY_MODE_RAW, a read waits for min chars (or len, if fewer), but returns what is there after timeout ticks
+// min 0 with timeout 0 never waits, and min 0 with a timeout waits for the first char until the timeout
+// timeout 0 otherwise means no timeout, min and timeout are ignored in TTY_MODE_CANONICAL
+int TtySetMode(int tty_id, int mode, int min, int timeout);
+
+// set the flags of the calling process for the terminal, return the flags it had before
+// with TTY_NONBLOCK, TtyRead returns TTY_WOULD_BLOCK if there is nothing to read yet
+// and TtyWrite queues what fits in the transmit ring, or returns TTY_WOULD_BLOCK if nothing does
+int TtySetFlags(int tty_id, int flags);
+
+// wait until one of the n terminals (or pty ends) in fds is ready for its events, or for timeout ticks
+// timeout 0 returns at once and a negative timeout waits forever
+// return the number of entries with revents set, 0 after the timeout
+int Poll(struct poll_fd *fds, int n, int timeout);
+
+// open a pseudo-terminal pair and store the terminal ids of its ends, above NUM_TERMINALS
+// TtyRead and TtyWrite work on both ends, what one end writes the other one reads a line at a time
+// the pair belongs to the calling process, only it and its descendants may use or close the ends
+// and the ends it leaves open are closed when it ends
+// return ERROR if every pair is in use
+int PtyOpen(int *master, int *slave);
+
+// close one end of a pair, reading the other end then returns 0 once the chars written before are read
+// and writing to it returns ERROR, the pair is free again when both ends are closed
+int PtyClose(int tty_id);
+
+// create a pipe and store its id in pipe_idp, return ERROR if there are too many pipes
+int PipeInit(int *pipe_idp);
+
+// read at most len chars from the pipe, blocking until there is at least one
+// the readers get the chars in the order they came to read, return the number of chars read
+int PipeRead(int pipe_id, void *buf, int len);
+
+// write the len chars to the pipe, blocking while it is full, a write of at most 4096 chars is never split
+// return len, or ERROR if the pipe does not exist or is reclaimed meanwhile
+int PipeWrite(int pipe_id, void *buf, int len);
+
+// free the pipe (or the other kernel object) with the id, the processes blocked on it get ERROR
+int Reclaim(int id);
+
+// create a lock and store its id in lock_idp, return ERROR if there are too many locks
+int LockInit(int *lock_idp);
+
+// acquire the lock, blocking until it is handed over, the waiters get it in the order they came
+int Acquire(int lock_id);
+
+// release the lock, which goes straight to its first waiter
+int Release(int lock_id);
+
+// create a condition variable and store its id in cvar_idp
+int CvarInit(int *cvar_idp);
+
+// release the lock and wait for a signal on the condition variable, the lock is held again on return
+int CvarWait(int cvar_id, int lock_id);
+
+// let the first waiter of the condition variable go on
+int CvarSignal(int cvar_id);
+
+// let every waiter of the condition variable go on, one at a time as they get the lock
+int CvarBroadcast(int cvar_id);
+
+// block until a FutexWake on the word at addr, if the word still holds expected
+// with a positive timeout, give up after that many clock ticks and return FUTEX_TIMED_OUT
+// return 0 when woken or when the word no longer holds expected, the caller checks the word again either way
+int FutexWait(int *addr, int expected, int timeout);
+
+// wake at most count processes blocked in FutexWait on the word at addr, return how many were woken
+int FutexWake(int *addr, int count);
+
+// select the WAKE_PREEMPT policy of the whole system, return the policy it had before or ERROR
+int SetWakePreempt(int policy);
+
+#ifdef KERNEL_CALL_DECLARES_IPC
+// make the calling process the server of the service, so Send(msg, -service_id) goes to it
+int Register(unsigned int service_id);
+
+// send the MESSAGE_SIZE bytes of msg to the process with the pid (or the server of the service -pid)
+// and block until it replies, the reply overwrites msg, return 0 or ERROR
+int Send(void *msg, int pid);
+
+// wait for a message, copy it into msg and return the pid of the sender
+int Receive(void *msg);
+
+// copy the MESSAGE_SIZE bytes of msg into the message of the sender with the pid and unblock it
+int Reply(void *msg, int pid);
+
+// copy len bytes from src of the sender with the pid into dest, while it waits for the reply
+int CopyFrom(int srcpid, void *dest, void *src, int len);
+
+// copy len bytes from src into dest of the sender with the pid, while it waits for the reply
+int CopyTo(int destpid, void *dest, void *src, int len);
+#endif
+
+#endif // YALNIX_KERNEL_CALL_H
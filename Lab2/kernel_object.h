@@ -0,0 +1,26 @@
+#ifndef YALNIX_KERNEL_OBJECT_H
+#define YALNIX_KERNEL_OBJECT_H
+// this file defines the ids of the kernel objects that Reclaim frees
+// an id carries the type of the object above OBJECT_TYPE_SHIFT, the generation of its slot below it
+// and the slot in the table of the type at the bottom
+// so an id is looked up in constant time, the id of one type is never taken for another
+// and a stale id of a reclaimed object does not reach the next object created in the same slot
+
+enum ObjectType
+{
+  OBJECT_PIPE = 1,
+  OBJECT_LOCK,
+  OBJECT_CVAR,
+};
+
+#define OBJECT_TYPE_SHIFT 24
+#define OBJECT_GENERATION_SHIFT 12
+// the generation wraps around after this many reuses of a slot
+#define OBJECT_GENERATION_MASK ((1 << (OBJECT_TYPE_SHIFT - OBJECT_GENERATION_SHIFT)) - 1)
+
+#define MAKE_OBJECT_ID(type, generation, index) (((type) << OBJECT_TYPE_SHIFT) | (((generation) & OBJECT_GENERATION_MASK) << OBJECT_GENERATION_SHIFT) | (index))
+#define OBJECT_TYPE(id) ((id) >> OBJECT_TYPE_SHIFT)
+#define OBJECT_GENERATION(id) (((id) >> OBJECT_GENERATION_SHIFT) & OBJECT_GENERATION_MASK)
+#define OBJECT_INDEX(id) ((id) & ((1 << OBJECT_GENERATION_SHIFT) - 1))
+
+#endif // YALNIX_KERNEL_OBJECT_H
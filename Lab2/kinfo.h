@@ -0,0 +1,56 @@
+#ifndef YALNIX_KINFO_H
+#define YALNIX_KINFO_H
+#include <comp421/hardware.h>
+// this file is the kernel info page, mapped read-only at the top of every region 0
+// the kernel rewrites it on every dispatch and clock tick, so a program reads its pid or the clock without a trap
+// include it in the user program, there is no library to link
+
+// the info page takes the page right below the kernel stack, the user stack ends under it
+#define KERNEL_INFO_VADDR (USER_STACK_LIMIT - PAGESIZE)
+
+struct kernel_info
+{
+  int seq;              // bumped on every update, a reader that sees it change reads again
+  int pid;              // the running process
+  int ppid;             // its parent
+  int ticks;            // clock ticks since boot, never reset
+  int context_switches; // dispatches of a different process since boot
+  int processes;        // processes alive, the idle process aside
+  int idle_ticks;       // clock ticks that found nothing to run
+};
+
+#define KINFO ((volatile struct kernel_info *)KERNEL_INFO_VADDR)
+
+static inline int kinfoPid()
+{
+  return KINFO->pid;
+}
+
+static inline int kinfoPpid()
+{
+  return KINFO->ppid;
+}
+
+static inline int kinfoTicks()
+{
+  return KINFO->ticks;
+}
+
+// copy the whole page at once, the fields all come from the same update
+static inline void kinfoRead(struct kernel_info *info)
+{
+  int seq;
+  do
+  {
+    seq = KINFO->seq;
+    info->pid = KINFO->pid;
+    info->ppid = KINFO->ppid;
+    info->ticks = KINFO->ticks;
+    info->context_switches = KINFO->context_switches;
+    info->processes = KINFO->processes;
+    info->idle_ticks = KINFO->idle_ticks;
+  } while (seq != KINFO->seq);
+  info->seq = seq;
+}
+
+#endif // YALNIX_KINFO_H
@@ -92,13 +92,13 @@ int LoadProgram(char *name, char **args)
    *  pointers) times the size of each (sizeof(void *)).  The
    *  value must also be aligned down to a multiple of 8 boundary.
    */
-  cp = ((char *)USER_STACK_LIMIT) - size;
+  cp = ((char *)USER_STACK_TOP) - size;
   cpp = (char **)((unsigned long)cp & (-1 << 4)); /* align cpp */
   cpp = (char **)((unsigned long)cpp - ((argcount + 4) * sizeof(void *)));
 
   text_npg = li.text_size >> PAGESHIFT;
   data_bss_npg = UP_TO_PAGE(li.data_size + li.bss_size) >> PAGESHIFT;
-  stack_npg = (USER_STACK_LIMIT - DOWN_TO_PAGE(cpp)) >> PAGESHIFT;
+  stack_npg = (USER_STACK_TOP - DOWN_TO_PAGE(cpp)) >> PAGESHIFT;
 
   TracePrintf(3, "LoadProgram: text_npg %d, data_bss_npg %d, stack_npg %d\n",
               text_npg, data_bss_npg, stack_npg);
@@ -106,10 +106,10 @@ int LoadProgram(char *name, char **args)
   /*
    *  Make sure we have enough *virtual* memory to fit everything within
    *  the size of a page table, including leaving at least one page
-   *  between the heap and the user stack
+   *  between the heap and the user stack, and the info page above the stack
    */
   if (MEM_INVALID_PAGES + text_npg + data_bss_npg + 1 + stack_npg +
-          1 + KERNEL_STACK_PAGES >
+          1 + 1 + KERNEL_STACK_PAGES >
       PAGE_TABLE_LEN)
   {
     TracePrintf(0,
@@ -132,7 +132,8 @@ int LoadProgram(char *name, char **args)
   // freed below before we allocate the needed pages for
   // the new program being loaded.
 
-  int page_count = getPageCount();
+  // the container of the process may allow fewer pages than there are free
+  int page_count = getFramesLeft();
 
   struct pte *page_table = PAGE_TABLE_0_VADDR;
 
@@ -141,7 +142,7 @@ int LoadProgram(char *name, char **args)
 
   int free_page_count = 0;
 
-  for (i = MEM_INVALID_SIZE; i < USER_STACK_LIMIT; i += PAGESIZE)
+  for (i = MEM_INVALID_SIZE; i < USER_STACK_TOP; i += PAGESIZE)
   {
     int page_table_index = i >> PAGESHIFT;
     if (page_table[page_table_index].valid)
@@ -184,8 +185,8 @@ int LoadProgram(char *name, char **args)
   // of these PTEs to be no longer valid.
 
   // because we use the page between USER_STACK_LIMIT and KERNEL_STACK_BASE as the page table
-  // we cannot free it
-  for (i = MEM_INVALID_SIZE; i < USER_STACK_LIMIT; i += PAGESIZE)
+  // we cannot free it, nor the info page shared by every process right under it
+  for (i = MEM_INVALID_SIZE; i < USER_STACK_TOP; i += PAGESIZE)
     removePageTableEntry(page_table, i, 1);
 
   /*
@@ -222,14 +223,14 @@ int LoadProgram(char *name, char **args)
   /* And finally the user stack pages */
   // For stack_npg number of PTEs in the Region 0 page table
   // corresponding to the user stack (the last page of the
-  // user stack *ends* at virtual address USER_STACK_LIMIT),
+  // user stack *ends* at virtual address USER_STACK_TOP, under the info page),
   // initialize each PTE:
   //     valid = 1
   //     kprot = PROT_READ | PROT_WRITE
   //     uprot = PROT_READ | PROT_WRITE
   //     pfn   = a new page of physical memory
   for (i = 0; i < stack_npg; i++)
-    writePageTableEntry(PAGE_TABLE_0_VADDR, USER_STACK_LIMIT - ((i + 1) << PAGESHIFT), allocatePage(), PROT_READ | PROT_WRITE, PROT_READ | PROT_WRITE);
+    writePageTableEntry(PAGE_TABLE_0_VADDR, USER_STACK_TOP - ((i + 1) << PAGESHIFT), allocatePage(), PROT_READ | PROT_WRITE, PROT_READ | PROT_WRITE);
 
   /*
    *  All pages for the new address space are now in place.  Flush
@@ -239,10 +240,10 @@ int LoadProgram(char *name, char **args)
   WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
 
   // the initial brk for the current process is the end of the data segment
-  current_process->brk = (MEM_INVALID_PAGES + text_npg + data_bss_npg) << PAGESHIFT;
+  current_process->space->brk = (MEM_INVALID_PAGES + text_npg + data_bss_npg) << PAGESHIFT;
   // the initial stack pointer for the current process is the lowest address of the last valid page of the user stack
-  current_process->stk = DOWN_TO_PAGE(cpp);
-  // current_process->stk = USER_STACK_LIMIT - (stack_npg << PAGESHIFT)
+  current_process->space->stk = DOWN_TO_PAGE(cpp);
+  // current_process->space->stk = USER_STACK_TOP - (stack_npg << PAGESHIFT)
 
   // there might be something messing up with the page table address, but I don't know what it is
   // TracePrintf(0, "current process page table 0x%x\n", current_process->page_table);
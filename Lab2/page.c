@@ -5,6 +5,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "page.h"
+#include "pcb.h"
+#include "container.h"
 
 // memory size
 static unsigned int memory_size;
@@ -19,6 +21,11 @@ static unsigned char *free_page_bitmap;
 static int page_next = MEM_INVALID_PAGES - 1;
 // keep track of the free page count
 static int page_count;
+// the container each page is charged to, NULL for the kernel and free pages
+static struct container **page_owner;
+// the number of pins on each page, and whether the page was freed while pinned
+static int *page_pins;
+static unsigned char *page_free_pending;
 // can we use rest half page? if it is -1, we need a new page
 // else it shall be the address of the half page
 static uintptr_t half_page = (uintptr_t)-1;
@@ -34,6 +41,9 @@ void initPagePool(unsigned int pmem_size)
   int bitmap_size = (total_pages + 7) / 8;
   // initialize the bitmap
   free_page_bitmap = (unsigned char *)malloc(bitmap_size * sizeof(unsigned char));
+  page_owner = (struct container **)calloc(total_pages, sizeof(struct container *));
+  page_pins = (int *)calloc(total_pages, sizeof(int));
+  page_free_pending = (unsigned char *)calloc(total_pages, sizeof(unsigned char));
   page_count = total_pages;
   // initialize the bitmap
   // fill all bit as 1
@@ -56,6 +66,24 @@ int getPageCount()
   return page_count;
 }
 
+// the container to charge the pages to, the kernel itself is not charged before any process runs
+static struct container *chargedContainer()
+{
+  struct pcb *current_process = getCurrentProcess();
+  if (current_process == NULL)
+    return NULL;
+  return current_process->container;
+}
+
+int getFramesLeft()
+{
+  struct container *container = chargedContainer();
+  if (container == NULL || container->frame_limit == 0)
+    return page_count;
+  int frames_left = container->frame_limit - container->frames;
+  return frames_left < page_count ? frames_left : page_count;
+}
+
 // utility function to check if a page is free
 static int isPageFree(int index)
 {
@@ -124,9 +152,15 @@ int usePage(uintptr_t addr)
   return 0;
 }
 
-// allocate a page
-uintptr_t allocatePage()
+// allocate a page charged to the container
+static uintptr_t allocateChargedPage(struct container *container)
 {
+  if (!canChargeFrames(container, 1))
+  {
+    TracePrintf(0, "allocatePage: container %d is out of frames\n", container->id);
+    return -1;
+  }
+
   int index = findFreePage();
   if (index == -1)
   {
@@ -136,10 +170,23 @@ uintptr_t allocatePage()
 
   uintptr_t page = (uintptr_t)(index << PAGESHIFT);
   markPageUsed(index);
+  page_owner[index] = container;
+  chargeFrame(container);
   // TracePrintf(3, "allocatePage: allocated page %d, with address 0x%x\n", index, page);
   return page;
 }
 
+// allocate a page
+uintptr_t allocatePage()
+{
+  return allocateChargedPage(chargedContainer());
+}
+
+uintptr_t allocateKernelPage()
+{
+  return allocateChargedPage(NULL);
+}
+
 // free a page
 void freePage(uintptr_t addr)
 {
@@ -151,16 +198,42 @@ void freePage(uintptr_t addr)
     return;
   }
 
+  if (page_pins[index] > 0)
+  {
+    // the page can not be reused while a terminal still transmits from it
+    TracePrintf(3, "freePage: page 0x%x is pinned, it will be freed when unpinned\n", addr);
+    page_free_pending[index] = 1;
+    return;
+  }
+
   markPageFree(index);
+  unchargeFrame(page_owner[index]);
+  page_owner[index] = NULL;
   // TracePrintf(3, "freePage: page 0x%x with index %d is freed\n", addr, index);
 }
 
-// allocate multiple pages, and put the addresses in new_pages
+void pinPage(uintptr_t addr)
+{
+  page_pins[addr >> PAGESHIFT]++;
+}
+
+void unpinPage(uintptr_t addr)
+{
+  int index = addr >> PAGESHIFT;
+  page_pins[index]--;
+  if (page_pins[index] == 0 && page_free_pending[index])
+  {
+    page_free_pending[index] = 0;
+    freePage(addr);
+  }
+}
+
+// allocate multiple pages charged to the container, and put the addresses in new_pages
 // either all pages are allocated, or none of them are allocated
-int allocateMultiPage(int new_page_count, uintptr_t new_pages[new_page_count])
+static int allocateChargedMultiPage(int new_page_count, uintptr_t new_pages[new_page_count], struct container *container)
 {
   // we can do the check before hand
-  if (page_count < new_page_count)
+  if (page_count < new_page_count || !canChargeFrames(container, new_page_count))
   {
     TracePrintf(0, "allocateMultiPage: out of memory\n");
     return -1;
@@ -168,7 +241,7 @@ int allocateMultiPage(int new_page_count, uintptr_t new_pages[new_page_count])
   int i;
   for (i = 0; i < new_page_count; i++)
   {
-    new_pages[i] = allocatePage();
+    new_pages[i] = allocateChargedPage(container);
     // this shall not happen, but just in case
     if (new_pages[i] == (uintptr_t)-1)
     {
@@ -186,6 +259,16 @@ int allocateMultiPage(int new_page_count, uintptr_t new_pages[new_page_count])
   return 0;
 }
 
+int allocateMultiPage(int new_page_count, uintptr_t new_pages[new_page_count])
+{
+  return allocateChargedMultiPage(new_page_count, new_pages, chargedContainer());
+}
+
+int allocateKernelMultiPage(int new_page_count, uintptr_t new_pages[new_page_count])
+{
+  return allocateChargedMultiPage(new_page_count, new_pages, NULL);
+}
+
 // helper to print the page table
 void printPagePool()
 {
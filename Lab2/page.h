@@ -15,22 +15,39 @@ void initPagePool(unsigned int pmem_size);
 // keep track of the free page count
 int getPageCount();
 
+// the number of pages the current process can still allocate
+// it is limited by both the free pages and the frame limit of the process's container
+int getFramesLeft();
+
 // mark this page as used manually
 int usePage(uintptr_t addr);
 
-// allocate a page
+// allocate a page, charged to the container of the current process
 uintptr_t allocatePage();
 
+// same as allocatePage, but the page belongs to the kernel and is not charged to any container
+uintptr_t allocateKernelPage();
+
 // allocate half a page, used for page table
 uintptr_t allocateHalfPage();
 
-// free a page
+// free a page, and uncharge it from the container it was charged to
 void freePage(uintptr_t addr);
 
+// keep the page from being freed, a terminal may still be transmitting from it
+// freePage on a pinned page only takes effect once the last pin is gone
+void pinPage(uintptr_t addr);
+
+// drop a pin of the page, and free it now if it was freed while pinned
+void unpinPage(uintptr_t addr);
+
 // allocate multiple pages, and put the addresses in new_pages
 // either all pages are allocated, or none of them are allocated
 int allocateMultiPage(int page_count, uintptr_t new_pages[page_count]);
 
+// same as allocateMultiPage, but the pages belong to the kernel and are not charged to any container
+int allocateKernelMultiPage(int page_count, uintptr_t new_pages[page_count]);
+
 // helper to print the page table
 void printPagePool();
 
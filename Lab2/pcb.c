@@ -5,6 +5,9 @@
 #include <comp421/yalnix.h>
 #include "pcb.h"
 #include "pte.h"
+#include "clock.h"
+#include "container.h"
+#include "info_page.h"
 
 static int pid_counter = 0;
 static struct pcb *current_process = NULL;
@@ -12,17 +15,12 @@ static struct pcb *current_process = NULL;
 static struct pcb *execution_list_head = NULL;
 static struct pcb *execution_list_tail = NULL;
 
-static struct pcb *delay_list_head = NULL;
-static struct pcb *delay_list_tail = NULL;
+// the processes sleeping on wait queues, the queues themselves decide who wakes up
+static struct pcb *blocked_list_head = NULL;
+static struct pcb *blocked_list_tail = NULL;
 
-static struct pcb *wait_list_head = NULL;
-static struct pcb *wait_list_tail = NULL;
-
-static struct pcb *tty_read_list_head = NULL;
-static struct pcb *tty_read_list_tail = NULL;
-
-static struct pcb *tty_write_list_head = NULL;
-static struct pcb *tty_write_list_tail = NULL;
+static struct pcb *rt_list_head = NULL;
+static struct pcb *rt_list_tail = NULL;
 
 // static struct pcb *init_process = NULL;
 static struct pcb *idle_process = NULL;
@@ -37,20 +35,14 @@ static int process_count = 0;
   memset(tail, 0, sizeof(struct pcb)); \
   head->pid = -1;                      \
   tail->pid = -1;                      \
-  head->tty_read_id = -1;              \
-  tail->tty_read_id = -1;              \
-  head->tty_write_id = -1;             \
-  tail->tty_write_id = -1;             \
   head->next = tail;                   \
   tail->prev = head;
 
 void initProcessManager()
 {
   INIT_HEAD_TAIL(execution_list_head, execution_list_tail);
-  INIT_HEAD_TAIL(delay_list_head, delay_list_tail);
-  INIT_HEAD_TAIL(wait_list_head, wait_list_tail);
-  INIT_HEAD_TAIL(tty_read_list_head, tty_read_list_tail);
-  INIT_HEAD_TAIL(tty_write_list_head, tty_write_list_tail);
+  INIT_HEAD_TAIL(blocked_list_head, blocked_list_tail);
+  INIT_HEAD_TAIL(rt_list_head, rt_list_tail);
 }
 
 struct pcb *createProcess()
@@ -59,13 +51,66 @@ struct pcb *createProcess()
 
   memset(pcb, 0, sizeof(struct pcb));
   pcb->pid = pid_counter++;
-  pcb->tty_read_id = -1;
+  pcb->status = -1;
+  pcb->usage_state = USAGE_NONE;
+  pcb->usage_since = getTickCount();
+  initWaitQueue(&pcb->child_exit, USAGE_WAIT, 0);
+  pcb->tgid = pcb->pid;
+  initWaitQueue(&pcb->msg_wait, USAGE_WAIT, 0);
   return pcb;
 }
 
+// add the clock ticks since usage_since to the counter of the state
+static void chargeUsageTicks(struct process_usage *usage, int state, int ticks)
+{
+  switch (state)
+  {
+  case USAGE_RUNNABLE:
+    usage->runnable_ticks += ticks;
+    break;
+  case USAGE_DELAY:
+    usage->delay_ticks += ticks;
+    break;
+  case USAGE_WAIT:
+    usage->wait_ticks += ticks;
+    break;
+  case USAGE_TTY_READ:
+    usage->tty_read_ticks += ticks;
+    break;
+  case USAGE_TTY_WRITE:
+    usage->tty_write_ticks += ticks;
+    break;
+  default:
+    break;
+  }
+}
+
+// move the process into another usage state, and charge the ticks of the old one
+static void setUsageState(struct pcb *pcb, int state)
+{
+  int tick = getTickCount();
+  chargeUsageTicks(&pcb->usage, pcb->usage_state, tick - pcb->usage_since);
+  pcb->usage_state = state;
+  pcb->usage_since = tick;
+}
+
+void getProcessUsage(struct pcb *pcb, struct process_usage *usage)
+{
+  *usage = pcb->usage;
+  usage->rt_periods = pcb->rt_periods;
+  usage->rt_misses = pcb->rt_misses;
+  chargeUsageTicks(usage, pcb->usage_state, getTickCount() - pcb->usage_since);
+}
+
 void setCurrentProcess(struct pcb *pcb)
 {
+  // a process that leaves the cpu while still in a runnable list waits for it again
+  if (current_process != NULL && current_process->usage_state == USAGE_RUNNING)
+    setUsageState(current_process, USAGE_RUNNABLE);
   current_process = pcb;
+  if (pcb->status == EXECUTION_LIST || pcb->status == RT_LIST)
+    setUsageState(pcb, USAGE_RUNNING);
+  dispatchInfoPage(pcb);
 }
 
 struct pcb *getCurrentProcess()
@@ -78,38 +123,59 @@ void setIdleProcess(struct pcb *pcb)
   idle_process = pcb;
 }
 
+struct pcb *getIdleProcess()
+{
+  return idle_process;
+}
+
 struct pcb *getNextProcess(int include_self)
 {
-  if (current_process == idle_process)
+  // the deadline processes go first, the earliest deadline is at the front
+  // but the cpu limit of their container holds for them too
+  int tick = getTickCount();
+  struct pcb *deadline_process;
+  for (deadline_process = rt_list_head->next; deadline_process != rt_list_tail; deadline_process = deadline_process->next)
+    if ((deadline_process != current_process || include_self) && !isContainerThrottled(deadline_process->container, tick))
+      return deadline_process;
+
+  // round robin over the execution list, starting after the current process
+  // or from the front if the current process is not in it
+  // the processes whose container has used up its cpu limit are skipped
+  struct pcb *start = current_process;
+  if (current_process == idle_process || current_process->status != EXECUTION_LIST)
+    start = execution_list_tail->prev;
+
+  struct pcb *candidate = start;
+  do
   {
-    if (execution_list_head->next == execution_list_tail)
+    candidate = candidate->next;
+    if (candidate == execution_list_tail)
+      candidate = execution_list_head->next;
+    if (candidate == execution_list_tail)
       // this means there is no process in the execution list
       // we need to keep on running the idle process
       return idle_process;
-    else
-      return execution_list_head->next;
-  }
-  else
-  {
-    if (current_process == execution_list_tail->prev)
-    // last process in the list
+
+    if (candidate == current_process)
     {
-      if (current_process == execution_list_head->next)
-      // only one process in the list
-      {
-        if (include_self)
-          return current_process;
-        else
-          return idle_process;
-      }
+      // we have gone all the way around to the current process
+      if (include_self && !isContainerThrottled(current_process->container, tick))
+        return current_process;
       else
-      {
-        return execution_list_head->next;
-      }
+        return idle_process;
     }
-    else
-      return current_process->next;
-  }
+
+    if (!isContainerThrottled(candidate->container, tick))
+      return candidate;
+  } while (candidate != start);
+
+  // everyone is throttled
+  return idle_process;
+}
+
+int hasRunnableProcess()
+{
+  return rt_list_head->next != rt_list_tail || execution_list_head->next != execution_list_tail;
 }
 
 // struct pcb *getNextTtyReadProcess(int tty_id)
@@ -127,14 +193,10 @@ struct pcb *getList(enum ListType type)
   {
   case EXECUTION_LIST:
     return execution_list_head;
-  case DELAY_LIST:
-    return delay_list_head;
-  case WAIT_LIST:
-    return wait_list_head;
-  case TTY_READ_LIST:
-    return tty_read_list_head;
-  case TTY_WRITE_LIST:
-    return tty_write_list_head;
+  case BLOCKED_LIST:
+    return blocked_list_head;
+  case RT_LIST:
+    return rt_list_head;
   default:
     return NULL;
   }
@@ -158,6 +220,7 @@ void removeProcessFromList(struct pcb *pcb)
   {
     pcb->next->prev = pcb->prev;
   }
+  pcb->status = -1;
 }
 
 void addProcessToList(struct pcb *pcb, enum ListType type)
@@ -166,19 +229,20 @@ void addProcessToList(struct pcb *pcb, enum ListType type)
   switch (type)
   {
   case EXECUTION_LIST:
-    tail = execution_list_tail;
-    break;
-  case DELAY_LIST:
-    tail = delay_list_tail;
-    break;
-  case WAIT_LIST:
-    tail = wait_list_tail;
-    break;
-  case TTY_READ_LIST:
-    tail = tty_read_list_tail;
+  case RT_LIST:
+    if (pcb->rt_period > 0 && pcb->rt_used < pcb->rt_budget)
+    {
+      type = RT_LIST;
+      tail = rt_list_tail;
+    }
+    else
+    {
+      type = EXECUTION_LIST;
+      tail = execution_list_tail;
+    }
     break;
-  case TTY_WRITE_LIST:
-    tail = tty_write_list_tail;
+  case BLOCKED_LIST:
+    tail = blocked_list_tail;
     break;
   default:
     TracePrintf(0, "addProcessToList: unknown type: %d\n", type);
@@ -186,8 +250,22 @@ void addProcessToList(struct pcb *pcb, enum ListType type)
   }
   // once added to a list, it is a valid process
   process_count++;
+  pcb->status = type;
+
+  if (type == BLOCKED_LIST)
+    setUsageState(pcb, pcb->wait_reason);
+  else
+    // the current process stays on the cpu when it is only moved between the runnable lists
+    setUsageState(pcb, pcb == current_process ? USAGE_RUNNING : USAGE_RUNNABLE);
 
   struct pcb *last = tail->prev;
+  if (type == RT_LIST)
+  {
+    // walk back from the tail to keep the deadline list sorted by rt_deadline, processes with the same deadline stay in order
+    while (last->pid >= 0 && last->rt_deadline > pcb->rt_deadline)
+      last = last->prev;
+    tail = last->next;
+  }
   last->next = pcb;
   pcb->prev = last;
   pcb->next = tail;
@@ -203,21 +281,13 @@ void printList(enum ListType type)
     TracePrintf(4, "printList: printing execution list\n");
     current = execution_list_head;
     break;
-  case DELAY_LIST:
-    TracePrintf(4, "printList: printing delay list\n");
-    current = delay_list_head;
-    break;
-  case WAIT_LIST:
-    TracePrintf(4, "printList: printing wait list\n");
-    current = wait_list_head;
-    break;
-  case TTY_READ_LIST:
-    TracePrintf(4, "printList: printing tty read list\n");
-    current = tty_read_list_head;
+  case BLOCKED_LIST:
+    TracePrintf(4, "printList: printing blocked list\n");
+    current = blocked_list_head;
     break;
-  case TTY_WRITE_LIST:
-    TracePrintf(4, "printList: printing tty write list\n");
-    current = tty_write_list_head;
+  case RT_LIST:
+    TracePrintf(4, "printList: printing deadline list\n");
+    current = rt_list_head;
     break;
   default:
     TracePrintf(0, "printList: unknown type: %d\n", type);
@@ -245,31 +315,73 @@ struct pcb *getProcessByPid(int pid)
       return current;
     current = current->next;
   }
-  current = delay_list_head;
+  current = blocked_list_head;
   while (current != NULL)
   {
     if (current->pid == pid)
       return current;
     current = current->next;
   }
-  current = wait_list_head;
+  current = rt_list_head;
   while (current != NULL)
   {
     if (current->pid == pid)
       return current;
     current = current->next;
   }
-  current = tty_read_list_head;
-  while (current != NULL)
+  return NULL;
+}
+
+int getProcessesByPgid(int pgid, struct pcb **processes, int max)
+{
+  struct pcb *heads[] = {execution_list_head, blocked_list_head, rt_list_head};
+  int count = 0;
+  unsigned int i;
+  for (i = 0; i < sizeof(heads) / sizeof(heads[0]); i++)
   {
-    if (current->pid == pid)
-      return current;
-    current = current->next;
+    struct pcb *current = heads[i]->next;
+    // the tail has pid -1
+    while (current->pid >= 0 && count < max)
+    {
+      if (current->pgid == pgid)
+        processes[count++] = current;
+      current = current->next;
+    }
   }
-  return NULL;
+  return count;
+}
+
+int getOtherThreads(struct pcb *pcb, struct pcb **threads, int max)
+{
+  struct pcb *heads[] = {execution_list_head, blocked_list_head, rt_list_head};
+  int count = 0;
+  unsigned int i;
+  for (i = 0; i < sizeof(heads) / sizeof(heads[0]); i++)
+  {
+    struct pcb *current = heads[i]->next;
+    // the tail has pid -1
+    while (current->pid >= 0 && count < max)
+    {
+      if (current->space == pcb->space && current != pcb)
+        threads[count++] = current;
+      current = current->next;
+    }
+  }
+  return count;
 }
 
 int countProcess()
 {
   return process_count;
-}
\ No newline at end of file
+}
+
+struct address_space *createAddressSpace(struct pcb *pcb, uintptr_t page_table)
+{
+  struct address_space *space = malloc(sizeof(struct address_space));
+  memset(space, 0, sizeof(struct address_space));
+  space->page_table = page_table;
+  space->users = 1;
+  initWaitQueue(&space->thread_exit, USAGE_WAIT, 0);
+  pcb->space = space;
+  return space;
+}
@@ -3,19 +3,44 @@
 
 #include <comp421/hardware.h>
 #include <stdint.h>
+#include "kernel_call.h"
+#include "wait_queue.h"
 
 #define IDLE_PROCESS 0
 #define INIT_PROCESS 1
 
+#define MAX_PRIORITY 4
+
 enum ListType
 {
   EXECUTION_LIST,
-  DELAY_LIST,
-  WAIT_LIST,
-  TTY_READ_LIST,
-  TTY_WRITE_LIST,
+  BLOCKED_LIST, // the processes sleeping on wait queues (see wait_queue.h)
+  RT_LIST, // the runnable deadline processes, they run before the ones in EXECUTION_LIST
 };
 
+// what the process is doing, for the usage accounting
+// the clock ticks spent in a state are charged when the process leaves it
+enum UsageState
+{
+  USAGE_NONE,
+  USAGE_RUNNING, // the running ticks are sampled by the clock instead
+  USAGE_RUNNABLE,
+  USAGE_DELAY,
+  USAGE_WAIT,
+  USAGE_TTY_READ,
+  USAGE_TTY_WRITE,
+};
+
+// the region 0 address space, a process has its own, while its threads share it
+typedef struct address_space
+{
+  uintptr_t page_table; // page table region 0 pointer (physical address)
+  uintptr_t stk;        // stack page pointer, the lowest address of the last valid page of the user stack
+  uintptr_t brk;        // the break of the process
+  int users;            // the number of processes and threads using the address space
+  struct wait_queue thread_exit; // the threads waiting in ThreadJoin
+} address_space;
+
 // the file manages the process control block
 typedef struct pcb
 {
@@ -28,17 +53,53 @@ typedef struct pcb
   // this is the real context including pc sp stc inside
   SavedContext ctx; // context of the process
 
-  int status;       // process status
+  int status;       // the list the process is currently in (enum ListType), -1 if none
   int pid;          // process id
-  int ppid;         // parent process id
-  int delay;        // delay time (clock tick)
-  int child_count;  // the number of children of the process currently running
-  int tty_read_id;  // the id of the terminal to read from
-  int tty_write_id; // the id of the terminal to write to
-
-  uintptr_t page_table; // page table region 0 pointer (physical address)
-  uintptr_t stk;        // stack page pointer, the lowest address of the last valid page of the user stack
-  uintptr_t brk;        // the break of the process
+  int ppid;         // parent process id, a thread has the parent of its process
+  int tgid;         // the pid of the main thread of the process, the same as pid unless it is a thread
+  int pgid;         // process group id, inherited by the children
+  int wake_tick;    // the clock tick to wake up at when sleeping on the timer queue
+  int child_count;  // the number of children of the process currently running, kept on the main thread
+  int wait_pid;     // the child pid the process is waiting for, -1 means any child (or several)
+  int priority;     // dynamic priority, raised when woken by terminal I/O and lowered when a whole quantum is used up
+
+  // the deadline scheduling class (see deadline.h)
+  int rt_period;   // the period in clock ticks, 0 for a normal process
+  int rt_budget;   // the clock ticks the process may run in each period
+  int rt_deadline; // the clock tick the current period ends at
+  int rt_used;     // the clock ticks used in the current period
+  int rt_periods;  // the number of periods that have ended
+  int rt_misses;   // the number of periods that ended while the process was still runnable short of its budget
+
+  struct address_space *space; // the region 0 address space, shared by the threads of a process
+  uintptr_t kernel_stack[KERNEL_STACK_PAGES]; // the physical pages of the kernel stack
+  int has_kernel_stack;                       // 1 if kernel_stack is recorded, which is only needed once the address space has threads
+
+  struct container *container; // the resource container the process is charged to
+
+  struct wait_entry waits[MAX_WAIT_QUEUES]; // the links into the queues the process sleeps on
+  int wait_count;                           // the number of queues the process sleeps on
+  int wait_reason;                          // the reason of the first of them (enum UsageState)
+  struct wait_queue *woken_by;              // the queue that woke the process up last time
+  struct wait_queue child_exit;             // the process sleeps here while waiting for its children
+
+  int tty_flags[NUM_TERMINALS]; // the flags of TtySetFlags for each terminal, inherited by the children
+
+  // the message passing (see ipc.h)
+  int msg_state;                // enum MessageState
+  void *msg;                    // the message buffer in the user memory while sending or receiving
+  int msg_peer;                 // the pid sent to, or received from
+  int msg_result;               // what Send returns, ERROR if the receiver has gone away
+  struct pcb *msg_senders;      // the senders waiting for the process to receive, oldest first
+  struct pcb *msg_senders_tail;
+  struct pcb *msg_next;         // the next sender waiting for the same receiver
+  struct wait_queue msg_wait;   // the process sleeps here in Send and Receive
+
+  int cvar_lock; // the lock a process waiting on a condition variable gets back, 0 when it is not waiting (see sync.h)
+
+  struct process_usage usage; // the resource usage so far
+  int usage_state;            // enum UsageState
+  int usage_since;            // the clock tick the process entered usage_state
 
   // we will use cyclic double linked list to store the process
   struct pcb *next;
@@ -58,15 +119,25 @@ struct pcb *getCurrentProcess();
 
 // get the next process
 // if include_self is 1, we will put current process into consideration
+// the deadline processes in RT_LIST always go before the normal ones
+// the processes whose container has used up its cpu limit are skipped, deadline or not
 struct pcb *getNextProcess(int include_self);
 
+// is there any process to run other than the idle process
+int hasRunnableProcess();
+
 // set the idle process
 void setIdleProcess(struct pcb *pcb);
 
+// get the idle process
+struct pcb *getIdleProcess();
+
 // get the list head of the list specified by the type
 struct pcb *getList(enum ListType type);
 
 // add the target process to the list specified by the type
+// a deadline process with budget left that is added to the execution list goes to RT_LIST instead,
+// which is kept sorted by rt_deadline
 void addProcessToList(struct pcb *pcb, enum ListType type);
 
 // free the pcb, the process will be removed from the list
@@ -81,7 +152,21 @@ void initProcessManager();
 // get the process count
 int countProcess();
 
+// get the other threads of the process the pcb belongs to, at most max of them
+// return the number of threads stored in threads
+int getOtherThreads(struct pcb *pcb, struct pcb **threads, int max);
+
 // get the process by pid, if not found, return NULL
 struct pcb *getProcessByPid(int pid);
 
+// collect at most max processes of the group into processes, return how many are collected
+// the processes of all the lists are included, the current process too
+int getProcessesByPgid(int pgid, struct pcb **processes, int max);
+
+// get the resource usage of the process, the ticks of its current state included
+void getProcessUsage(struct pcb *pcb, struct process_usage *usage);
+
+// create a new address space around the region 0 page table, with the process as its only user
+struct address_space *createAddressSpace(struct pcb *pcb, uintptr_t page_table);
+
 #endif // YALNIX_PCB_H
\ No newline at end of file
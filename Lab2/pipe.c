@@ -0,0 +1,127 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcb.h"
+#include "pipe.h"
+#include "pte.h"
+#include "kernel_object.h"
+
+static struct pipe pipes[MAX_PIPES];
+
+void initPipes()
+{
+  memset(pipes, 0, sizeof(pipes));
+  int i;
+  for (i = 0; i < MAX_PIPES; i++)
+  {
+    initWaitQueue(&pipes[i].readers, USAGE_WAIT, 0);
+    initWaitQueue(&pipes[i].writers, USAGE_WAIT, 0);
+  }
+}
+
+// get the pipe of the id, NULL if there is no such pipe
+static struct pipe *getPipe(int id)
+{
+  if (OBJECT_TYPE(id) != OBJECT_PIPE || OBJECT_INDEX(id) >= MAX_PIPES)
+    return NULL;
+  struct pipe *pipe = &pipes[OBJECT_INDEX(id)];
+  if (!pipe->in_use || OBJECT_GENERATION(id) != (pipe->generation & OBJECT_GENERATION_MASK))
+    return NULL;
+  return pipe;
+}
+
+int createPipe()
+{
+  int i;
+  for (i = 0; i < MAX_PIPES; i++)
+    if (!pipes[i].in_use)
+      break;
+  if (i == MAX_PIPES)
+    return ERROR;
+
+  struct pipe *pipe = &pipes[i];
+  pipe->ring = createBuffer(PIPE_BUFFER_SIZE, 0);
+  if (pipe->ring == NULL)
+    return ERROR;
+  pipe->in_use = 1;
+  return MAKE_OBJECT_ID(OBJECT_PIPE, pipe->generation, i);
+}
+
+// sleep on the queue of the pipe, return 0 when woken up, or ERROR if the pipe is reclaimed meanwhile
+static int sleepOnPipe(struct pipe *pipe, struct wait_queue *queue)
+{
+  int generation = pipe->generation;
+  sleepOn(queue);
+  return pipe->generation == generation ? 0 : ERROR;
+}
+
+int readPipe(int id, void *buf, int len)
+{
+  struct pipe *pipe = getPipe(id);
+  if (pipe == NULL)
+    return ERROR;
+
+  // a reader that finds others waiting queues up behind them, even if there are chars
+  if (isEmpty(pipe->ring) || !isWaitQueueEmpty(&pipe->readers))
+  {
+    do
+    {
+      // and the buffer may be gone by the time we are woken up
+      if (sleepOnPipe(pipe, &pipe->readers) == ERROR || !isUserBuffer((uintptr_t)buf, len, PROT_WRITE))
+        return ERROR;
+    } while (isEmpty(pipe->ring));
+  }
+
+  len = getBuf(pipe->ring, buf, len, 0);
+  wakeOne(&pipe->writers);
+  // the chars left over go to the next reader
+  if (!isEmpty(pipe->ring))
+    wakeOne(&pipe->readers);
+  return len;
+}
+
+int writePipe(int id, void *buf, int len)
+{
+  struct pipe *pipe = getPipe(id);
+  if (pipe == NULL)
+    return ERROR;
+
+  int written = 0;
+  while (written < len)
+  {
+    // a write that fits in the pipe goes in at once, so it is not interleaved with the others
+    int wanted = len - written < PIPE_BUFFER_SIZE ? len - written : PIPE_BUFFER_SIZE;
+    if (freeSpace(pipe->ring) < wanted || !isWaitQueueEmpty(&pipe->writers))
+    {
+      do
+      {
+        if (sleepOnPipe(pipe, &pipe->writers) == ERROR || !isUserBuffer((uintptr_t)buf + written, len - written, PROT_READ))
+          return ERROR;
+      } while (freeSpace(pipe->ring) < wanted);
+    }
+
+    written += addBuf(pipe->ring, buf + written, wanted);
+    wakeOne(&pipe->readers);
+  }
+
+  // the room left over goes to the next writer
+  if (freeSpace(pipe->ring) > 0)
+    wakeOne(&pipe->writers);
+  return len;
+}
+
+int reclaimPipe(int id)
+{
+  struct pipe *pipe = getPipe(id);
+  if (pipe == NULL)
+    return ERROR;
+
+  pipe->in_use = 0;
+  pipe->generation++;
+  wakeAll(&pipe->readers);
+  wakeAll(&pipe->writers);
+  freeBuffer(pipe->ring);
+  pipe->ring = NULL;
+  return 0;
+}
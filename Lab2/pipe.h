@@ -0,0 +1,40 @@
+#ifndef YALNIX_PIPE_H
+#define YALNIX_PIPE_H
+#include "tty_buffer.h"
+#include "wait_queue.h"
+// this file manages the pipes between processes
+// a pipe is a bounded ring of chars, its readers and writers block on its own queues and go in FIFO order
+
+// the most pipes that can exist at the same time
+#define MAX_PIPES 16
+
+// the chars a pipe holds, a power of two, a write of at most this many chars is never split
+#define PIPE_BUFFER_SIZE 4096
+
+struct pipe
+{
+  int in_use;
+  int generation;           // bumped when the pipe is reclaimed, so its sleepers and its old id know it is gone
+  tty_buf *ring;
+  struct wait_queue readers; // waiting for chars
+  struct wait_queue writers; // waiting for room
+};
+
+// initialize the table of pipes
+void initPipes();
+
+// create a pipe, return its id or ERROR if the table is full
+int createPipe();
+
+// read at most len chars, blocking until there is at least one
+// return the number of chars read, or ERROR if there is no such pipe
+int readPipe(int id, void *buf, int len);
+
+// write all len chars, blocking while the pipe is full
+// return len, or ERROR if there is no such pipe (or it is reclaimed meanwhile)
+int writePipe(int id, void *buf, int len);
+
+// free the pipe, its sleepers return ERROR, return ERROR if there is no such pipe
+int reclaimPipe(int id);
+
+#endif // YALNIX_PIPE_H
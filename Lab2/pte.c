@@ -3,6 +3,7 @@
 #include "page.h"
 #include "pte.h"
 #include "pcb.h"
+#include "info_page.h"
 
 static struct pte *page_table_1_vaddr = NULL;
 
@@ -72,7 +73,7 @@ int countPageTableEntries()
   int i;
   int valid_count = 0;
   for (i = 0; i < PAGE_TABLE_LEN; i++)
-    if (page_table_0_vaddr[i].valid)
+    if (page_table_0_vaddr[i].valid && i != (KERNEL_INFO_VADDR >> PAGESHIFT))
       valid_count++;
   return valid_count;
 }
@@ -108,6 +109,12 @@ int copyPageTableEntries(uintptr_t dest)
   int j = 0;
   for (i = 0; i < PAGE_TABLE_LEN; i++)
   {
+    if (i == (KERNEL_INFO_VADDR >> PAGESHIFT))
+    {
+      // every process maps the same info page
+      mapInfoPage(PAGE_TABLE_HELPER_1_VADDR);
+      continue;
+    }
     if (page_table_0_vaddr[i].valid)
     {
       uintptr_t virtual_address = i << PAGESHIFT;
@@ -133,4 +140,131 @@ int copyPageTableEntries(uintptr_t dest)
   WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR);
 
   return 0;
-}
\ No newline at end of file
+}
+
+void freePageTable(uintptr_t page_table, int free_kernel_stack)
+{
+  // borrow a page (PAGE_TABLE_HELPER_1_VADDR) to gain access to the page table
+  writePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR, page_table, PROT_READ | PROT_WRITE, PROT_NONE);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR);
+
+  struct pte *page_table_helper_1_vaddr = PAGE_TABLE_HELPER_1_VADDR;
+  int i;
+  for (i = MEM_INVALID_PAGES; i < PAGE_TABLE_LEN; i++)
+  {
+    if (!free_kernel_stack && i >= (KERNEL_STACK_BASE >> PAGESHIFT))
+      break;
+    // the info page is shared by every process
+    if (page_table_helper_1_vaddr[i].valid && i != (KERNEL_INFO_VADDR >> PAGESHIFT))
+      freePage(page_table_helper_1_vaddr[i].pfn << PAGESHIFT);
+  }
+
+  removePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR, 0);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR);
+  freePage(page_table);
+}
+
+int copyAddressSpace(uintptr_t page_table, uintptr_t addr, void *buf, int len, int to_other)
+{
+  // written so that addr + len cannot wrap around
+  if (len < 0 || addr >= USER_STACK_LIMIT || (uintptr_t)len > USER_STACK_LIMIT - addr)
+    return -1;
+
+  // borrow a page (PAGE_TABLE_HELPER_1_VADDR) to gain access to the page table
+  writePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR, page_table, PROT_READ | PROT_WRITE, PROT_NONE);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR);
+  struct pte *page_table_helper_1_vaddr = PAGE_TABLE_HELPER_1_VADDR;
+
+  // check every page before copying anything, so a failed copy leaves the other side untouched
+  int result = 0;
+  unsigned int prot = to_other ? PROT_WRITE : PROT_READ;
+  uintptr_t page;
+  for (page = addr >> PAGESHIFT; len > 0 && page <= (addr + len - 1) >> PAGESHIFT; page++)
+  {
+    struct pte *entry = &page_table_helper_1_vaddr[page];
+    if (!entry->valid || !(entry->uprot & prot))
+    {
+      result = -1;
+      break;
+    }
+  }
+
+  while (result == 0 && len > 0)
+  {
+    struct pte *entry = &page_table_helper_1_vaddr[addr >> PAGESHIFT];
+
+    // and another one (PAGE_TABLE_HELPER_2_VADDR) for the page of addr itself
+    writePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR, entry->pfn << PAGESHIFT, PROT_READ | PROT_WRITE, PROT_NONE);
+    WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR);
+
+    int offset = addr & PAGEOFFSET;
+    int chunk = PAGESIZE - offset < len ? PAGESIZE - offset : len;
+    void *window = (void *)PAGE_TABLE_HELPER_2_VADDR + offset;
+    if (to_other)
+      memcpy(window, buf, chunk);
+    else
+      memcpy(buf, window, chunk);
+
+    addr += chunk;
+    buf += chunk;
+    len -= chunk;
+  }
+
+  removePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR, 0);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR);
+  removePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR, 0);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_1_VADDR);
+  return result;
+}
+
+int isUserBuffer(uintptr_t addr, int len, unsigned int prot)
+{
+  if (len <= 0)
+    return len == 0;
+  if (addr >= USER_STACK_LIMIT || (uintptr_t)len > USER_STACK_LIMIT - addr)
+    return 0;
+
+  struct pte *page_table_0_vaddr = PAGE_TABLE_0_VADDR;
+  uintptr_t page;
+  for (page = DOWN_TO_PAGE(addr); page < addr + len; page += PAGESIZE)
+  {
+    struct pte *entry = &page_table_0_vaddr[page >> PAGESHIFT];
+    if (!entry->valid || (entry->uprot & prot) != prot)
+      return 0;
+  }
+  return 1;
+}
+
+void getKernelStackPages(uintptr_t pages[KERNEL_STACK_PAGES])
+{
+  struct pte *page_table_0_vaddr = PAGE_TABLE_0_VADDR;
+  int i;
+  for (i = 0; i < KERNEL_STACK_PAGES; i++)
+    pages[i] = page_table_0_vaddr[(KERNEL_STACK_BASE >> PAGESHIFT) + i].pfn << PAGESHIFT;
+}
+
+void copyKernelStack(uintptr_t pages[KERNEL_STACK_PAGES])
+{
+  int i;
+  for (i = 0; i < KERNEL_STACK_PAGES; i++)
+  {
+    // borrow a page (PAGE_TABLE_HELPER_2_VADDR) to gain access to the new page
+    writePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR, pages[i], PROT_READ | PROT_WRITE, PROT_NONE);
+    WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR);
+    memcpy((void *)PAGE_TABLE_HELPER_2_VADDR, (void *)(KERNEL_STACK_BASE + (i << PAGESHIFT)), PAGESIZE);
+  }
+  removePageTableEntry(page_table_1_vaddr, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR, 0);
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_HELPER_2_VADDR);
+}
+
+void mapKernelStack(uintptr_t pages[KERNEL_STACK_PAGES], int flush)
+{
+  int i;
+  for (i = 0; i < KERNEL_STACK_PAGES; i++)
+  {
+    uintptr_t virtual_address = KERNEL_STACK_BASE + (i << PAGESHIFT);
+    writePageTableEntry(PAGE_TABLE_0_VADDR, virtual_address, pages[i], PROT_READ | PROT_WRITE, PROT_NONE);
+    if (flush)
+      WriteRegister(REG_TLB_FLUSH, virtual_address);
+  }
+}
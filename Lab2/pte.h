@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <comp421/hardware.h>
+#include "kinfo.h"
 // this file stores the utils corresponding to the page table entry
 
 // the page table itself of region 0 is at the end of the kernel's virtual memory
@@ -11,6 +12,15 @@
 #define PAGE_TABLE_HELPER_1_VADDR (struct pte *)(VMEM_1_LIMIT - 2 * PAGESIZE)
 // another temporary page to help with the page table creation
 #define PAGE_TABLE_HELPER_2_VADDR (struct pte *)(VMEM_1_LIMIT - 3 * PAGESIZE)
+// below them, each terminal has a window to map the user pages it is transmitting from
+// a line of TERMINAL_MAX_LINE chars spans at most TTY_WINDOW_PAGES pages
+#define TTY_WINDOW_PAGES 2
+#define TTY_WINDOW_VADDR(tty_id) (VMEM_1_LIMIT - (3 + TTY_WINDOW_PAGES * ((tty_id) + 1)) * PAGESIZE)
+// and below them, the window the kernel writes the info page through
+#define KERNEL_INFO_WINDOW_VADDR (TTY_WINDOW_VADDR(NUM_TERMINALS - 1) - PAGESIZE)
+
+// the user stack ends under the info page of region 0
+#define USER_STACK_TOP KERNEL_INFO_VADDR
 
 // a utility function to print the page table entries
 void printPageTableEntries(struct pte *page_table);
@@ -27,9 +37,33 @@ void removePageTableEntry(struct pte *page_table, uintptr_t virtual_address, int
 // return -1 if failed, 0 if success
 int copyPageTableEntries(uintptr_t dest);
 
-// count how many page is used for region 0
+// count how many page is used for region 0, which is how many a copy of it needs
+// the info page is shared, so it is not counted
 int countPageTableEntries();
 
+// free every page of a region 0 page table that is not the current one, and the page table itself
+// the kernel stack pages are skipped unless free_kernel_stack is set
+void freePageTable(uintptr_t page_table, int free_kernel_stack);
+
+// get the physical pages of the kernel stack from the current region 0 page table
+void getKernelStackPages(uintptr_t pages[KERNEL_STACK_PAGES]);
+
+// copy the content of the current kernel stack into the physical pages
+void copyKernelStack(uintptr_t pages[KERNEL_STACK_PAGES]);
+
+// point the kernel stack of the current region 0 page table to the physical pages
+// flush the TLB entries of these pages if flush is set
+void mapKernelStack(uintptr_t pages[KERNEL_STACK_PAGES], int flush);
+
+// copy len bytes between buf in the current region 0 and addr in the region 0 of another page table
+// into addr if to_other is set, else out of it, a page at a time through the helper windows
+// return -1 (before copying anything) if a page of addr is not valid or the user may not read (or write) it, 0 if success
+int copyAddressSpace(uintptr_t page_table, uintptr_t addr, void *buf, int len, int to_other);
+
+// whether the len bytes at addr are in pages of the current region 0 the user may access with prot
+// a thread checks its buffer again after sleeping, another thread may have given the pages back with Brk meanwhile
+int isUserBuffer(uintptr_t addr, int len, unsigned int prot);
+
 // set the region 1 page table address (virtual address) for later use
 void setPageTable1(struct pte *page_table);
 
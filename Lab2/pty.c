@@ -0,0 +1,209 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcb.h"
+#include "pty.h"
+#include "pte.h"
+
+static struct pty ptys[MAX_PTYS];
+// the pollers of any end, woken up by every read, write and close of a pair
+static struct wait_queue pty_poll_queue;
+
+void initPtys()
+{
+  memset(ptys, 0, sizeof(ptys));
+  initWaitQueue(&pty_poll_queue, USAGE_WAIT, 0);
+  int i, end;
+  for (i = 0; i < MAX_PTYS; i++)
+    for (end = 0; end < 2; end++)
+    {
+      initWaitQueue(&ptys[i].channel[end].readers, USAGE_TTY_READ, 0);
+      initWaitQueue(&ptys[i].channel[end].writers, USAGE_TTY_WRITE, 0);
+    }
+}
+
+// get the pair of the id, NULL if it is not an open end, and the end (0 the master, 1 the slave)
+static struct pty *getPty(int tty_id, int *end)
+{
+  int index = tty_id - NUM_TERMINALS;
+  if (index < 0 || index >= 2 * MAX_PTYS)
+    return NULL;
+
+  struct pty *pty = &ptys[index / 2];
+  *end = index % 2;
+  if (pty->open_ends == 0 || pty->closed[*end])
+    return NULL;
+  return pty;
+}
+
+int openPty(int *master, int *slave)
+{
+  int i;
+  for (i = 0; i < MAX_PTYS; i++)
+    if (ptys[i].open_ends == 0)
+      break;
+  if (i == MAX_PTYS)
+    return ERROR;
+
+  struct pty *pty = &ptys[i];
+  pty->channel[0].ring = createBuffer(PTY_RING_SIZE, 1);
+  pty->channel[1].ring = createBuffer(PTY_RING_SIZE, 1);
+  if (pty->channel[0].ring == NULL || pty->channel[1].ring == NULL)
+  {
+    freeBuffer(pty->channel[0].ring);
+    freeBuffer(pty->channel[1].ring);
+    return ERROR;
+  }
+
+  pty->open_ends = 2;
+  pty->closed[0] = 0;
+  pty->closed[1] = 0;
+  pty->owner = getCurrentProcess()->tgid;
+  *master = PTY_MASTER_ID(i);
+  *slave = PTY_MASTER_ID(i) + 1;
+  TracePrintf(2, "openPty: opened the pair %d with the master %d and the slave %d\n", i, *master, *slave);
+  return 0;
+}
+
+int closePty(int tty_id)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  if (pty == NULL)
+    return ERROR;
+
+  pty->closed[end] = 1;
+  pty->open_ends--;
+  // the other end sees the end of the stream, and stops waiting for room that will never come
+  wakeAll(&pty->channel[1 - end].readers);
+  wakeAll(&pty->channel[end].writers);
+  // so do the readers and writers of this end, blocked by another process of this end
+  wakeAll(&pty->channel[end].readers);
+  wakeAll(&pty->channel[1 - end].writers);
+  wakeAll(&pty_poll_queue);
+
+  if (pty->open_ends == 0)
+  {
+    pty->generation++;
+    freeBuffer(pty->channel[0].ring);
+    freeBuffer(pty->channel[1].ring);
+    pty->channel[0].ring = NULL;
+    pty->channel[1].ring = NULL;
+  }
+  return 0;
+}
+
+void dropPtys(struct pcb *pcb)
+{
+  // the threads share the pairs of their process
+  if (pcb->pid != pcb->tgid)
+    return;
+
+  int i, end;
+  for (i = 0; i < MAX_PTYS; i++)
+    if (ptys[i].open_ends > 0 && ptys[i].owner == pcb->tgid)
+      for (end = 0; end < 2; end++)
+        if (!ptys[i].closed[end])
+        {
+          TracePrintf(2, "dropPtys: closing the end %d left open by process %d\n", PTY_MASTER_ID(i) + end, pcb->pid);
+          closePty(PTY_MASTER_ID(i) + end);
+        }
+}
+
+// sleep on the queue of the pair, return 0 when woken up, or ERROR if the pair is freed meanwhile
+// (it may be open again by then, with the same ids and new rings)
+static int sleepOnPty(struct pty *pty, struct wait_queue *queue)
+{
+  int generation = pty->generation;
+  sleepOn(queue);
+  return pty->generation == generation ? 0 : ERROR;
+}
+
+int isPty(int tty_id)
+{
+  int end;
+  return getPty(tty_id, &end) != NULL;
+}
+
+int getPtyOwner(int tty_id)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  return pty == NULL ? ERROR : pty->owner;
+}
+
+int isPtyReadable(int tty_id)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  if (pty == NULL)
+    return 0;
+  // a read of a closed other end returns 0 at once
+  return !isEmpty(pty->channel[end].ring) || pty->closed[1 - end];
+}
+
+int isPtyWritable(int tty_id)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  if (pty == NULL)
+    return 0;
+  // and a write to it fails at once
+  return freeSpace(pty->channel[1 - end].ring) > 0 || pty->closed[1 - end];
+}
+
+struct wait_queue *getPtyPollQueue()
+{
+  return &pty_poll_queue;
+}
+
+int readPty(int tty_id, void *buf, int len)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  if (pty == NULL)
+    return ERROR;
+
+  // what the other end writes is in the channel of this end
+  struct pty_channel *channel = &pty->channel[end];
+  while (isEmpty(channel->ring))
+  {
+    if (pty->closed[1 - end])
+      return 0;
+    // this end may have been closed meanwhile, and the buffer may be gone
+    if (sleepOnPty(pty, &channel->readers) == ERROR || pty->closed[end] || !isUserBuffer((uintptr_t)buf, len, PROT_WRITE))
+      return ERROR;
+  }
+
+  len = getBuf(channel->ring, buf, len, 1);
+  wakeAll(&channel->writers);
+  wakeAll(&pty_poll_queue);
+  return len;
+}
+
+int writePty(int tty_id, void *buf, int len)
+{
+  int end;
+  struct pty *pty = getPty(tty_id, &end);
+  if (pty == NULL)
+    return ERROR;
+
+  struct pty_channel *channel = &pty->channel[1 - end];
+  int written = 0;
+  while (1)
+  {
+    if (pty->closed[1 - end] || pty->closed[end])
+      return ERROR;
+
+    written += addBuf(channel->ring, buf + written, len - written);
+    wakeAll(&channel->readers);
+    wakeAll(&pty_poll_queue);
+    if (written == len)
+      return len;
+
+    TracePrintf(3, "writePty: the ring of terminal %d is full, blocking the writing process with pid=%d\n", tty_id, getCurrentProcess()->pid);
+    if (sleepOnPty(pty, &channel->writers) == ERROR || !isUserBuffer((uintptr_t)buf + written, len - written, PROT_READ))
+      return ERROR;
+  }
+}
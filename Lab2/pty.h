@@ -0,0 +1,72 @@
+#ifndef YALNIX_PTY_H
+#define YALNIX_PTY_H
+#include <comp421/hardware.h>
+#include "tty_buffer.h"
+#include "wait_queue.h"
+
+struct pcb;
+// this file manages the pseudo-terminal pairs
+// a pair is two virtual terminals above NUM_TERMINALS, what is written to one end is read from the other
+// the chars move through a ring in each direction at memory speed, with the line reads of the receive ring
+
+// the most pairs open at the same time
+#define MAX_PTYS 4
+
+// the chars buffered in each direction of a pair
+#define PTY_RING_SIZE 4096
+
+// the master of pair i is the terminal PTY_MASTER_ID(i), and its slave the one after
+#define PTY_MASTER_ID(i) (NUM_TERMINALS + 2 * (i))
+
+// one direction of a pair
+struct pty_channel
+{
+  tty_buf *ring;
+  struct wait_queue readers; // waiting for a line in the ring
+  struct wait_queue writers; // waiting for room in the ring
+};
+
+struct pty
+{
+  int open_ends;                // 2 while both ends are open, the pair is freed when it is 0
+  int closed[2];                // 1 for the end (0 the master, 1 the slave) that has been closed
+  int owner;                    // the process that opened the pair, its descendants may use the ends until it ends
+  int generation;               // bumped when the pair is freed, so its sleepers know it is gone
+  struct pty_channel channel[2]; // channel[end] holds the chars written to the end
+};
+
+// initialize the table of pairs
+void initPtys();
+
+// open a new pair for the current process and store the ids of its ends, return ERROR if every pair is in use
+int openPty(int *master, int *slave);
+
+// close one end of a pair, the reader of the other end gets 0 once the ring is empty
+// and its writer gets ERROR, return ERROR if the end is not open
+int closePty(int tty_id);
+
+// close the ends still open of the pairs the process opened, when the whole process ends
+void dropPtys(struct pcb *pcb);
+
+// is the id an open end of a pair
+int isPty(int tty_id);
+
+// get the process that opened the pair of the end, ERROR if the id is not an open end
+int getPtyOwner(int tty_id);
+
+// would a read (or a write) of the end return without blocking, 0 if the id is not an open end
+int isPtyReadable(int tty_id);
+int isPtyWritable(int tty_id);
+
+// the queue Poll sleeps on for the ends of every pair
+struct wait_queue *getPtyPollQueue();
+
+// read the next line (at most len chars of it) written to the other end, blocking until there is one
+// return 0 if the other end is closed and nothing is left
+int readPty(int tty_id, void *buf, int len);
+
+// write the buffer for the other end to read, blocking while its ring is full
+// return ERROR if the other end is closed
+int writePty(int tty_id, void *buf, int len);
+
+#endif // YALNIX_PTY_H
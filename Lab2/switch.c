@@ -4,6 +4,7 @@
 #include "switch.h"
 #include "pcb.h"
 #include "pte.h"
+#include "page.h"
 
 SavedContext *NormalSwitch(SavedContext *ctxp, void *p1, void *p2)
 {
@@ -15,16 +16,28 @@ SavedContext *NormalSwitch(SavedContext *ctxp, void *p1, void *p2)
   // TracePrintf(3, "content of the current process's context: %s\n", current_process->ctx.s);
   // TracePrintf(3, "content of the next process's context: %s\n", next_process->ctx.s);
 
+  // threads of the same process share the page table, only the kernel stack differs
+  if (current_process->space == next_process->space)
+  {
+    setCurrentProcess(next_process);
+    mapKernelStack(next_process->kernel_stack, 1);
+    return &next_process->ctx;
+  }
+
   // copy the page table of the idle process to the init process
   setCurrentProcess(next_process);
 
-  uintptr_t page_table = next_process->page_table;
+  uintptr_t page_table = next_process->space->page_table;
 
   WriteRegister(REG_PTR0, (RCS421RegVal)page_table);
   // TODO: we also need to refresh the clock interrupt
   // put the new page table onto the virtual memory
   writePageTableEntry(getPageTable1(), (uintptr_t)PAGE_TABLE_0_VADDR, page_table, PROT_READ | PROT_WRITE, PROT_NONE);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  // only the page that maps the region 0 page table has changed in region 1
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_0_VADDR);
+  // a thread may run on a kernel stack other than the one in the shared page table
+  if (next_process->has_kernel_stack)
+    mapKernelStack(next_process->kernel_stack, 0);
   WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
 
   return &next_process->ctx;
@@ -37,7 +50,7 @@ SavedContext *ForkSwitch(SavedContext *ctxp, void *p1, void *p2)
 
   TracePrintf(2, "ForkSwitch: switch function is called for %d and %d\n", current_process->pid, next_process->pid);
 
-  uintptr_t page_table = next_process->page_table;
+  uintptr_t page_table = next_process->space->page_table;
 
   // TracePrintf(2, "ForkSwitch: next page table is 0x%x, while current page table is 0x%x\n", page_table, current_process->page_table);
 
@@ -50,6 +63,7 @@ SavedContext *ForkSwitch(SavedContext *ctxp, void *p1, void *p2)
     // we simply continue the current process
     TracePrintf(0, "ForkSwitch: failed to copy page table entries\n");
     removeProcessFromList(next_process);
+    free(next_process->space);
     free(next_process);
     return ctxp;
   }
@@ -77,28 +91,76 @@ SavedContext *ExitSwitch(SavedContext *ctxp, void *p1, void *p2)
 
   TracePrintf(2, "ExitSwitch: switch function is called for %d and %d\n", current_process->pid, next_process->pid);
   setCurrentProcess(next_process);
-  // we can free the current process
+  struct address_space *space = current_process->space;
+  space->users--;
+  if (space->users > 0)
+  {
+    // the other threads still use the address space, only our own kernel stack goes away
+    int i;
+    for (i = 0; i < KERNEL_STACK_PAGES; i++)
+      freePage(current_process->kernel_stack[i]);
+  }
+  else
+  {
+    // Exit the pages of the current process, but not the info page every process shares
+    int i;
+    for (i = MEM_INVALID_SIZE; i < VMEM_0_LIMIT; i += PAGESIZE)
+      removePageTableEntry(PAGE_TABLE_0_VADDR, i, i != KERNEL_INFO_VADDR);
+    // the page table stays in use until we load the next one, but nobody can allocate it before that
+    freePage(space->page_table);
+    free(space);
+  }
+  // we can free the current process, it has already been removed from its list
   TracePrintf(2, "ExitSwitch: free the current process %d\n", current_process->pid);
-  removeProcessFromList(current_process);
   free(current_process);
 
-  if (countProcess() == 0)
+  if (next_process->space == space)
   {
-    TracePrintf(2, "ExitSwitch: no more process, halt the system\n");
-    Halt();
+    mapKernelStack(next_process->kernel_stack, 1);
+    return &next_process->ctx;
   }
 
-  // Exit the pages of the current process
-  int i;
-  for (i = MEM_INVALID_SIZE; i < VMEM_0_LIMIT; i += PAGESIZE)
-    removePageTableEntry(PAGE_TABLE_0_VADDR, i, 1);
-
-  uintptr_t page_table = next_process->page_table;
+  uintptr_t page_table = next_process->space->page_table;
 
   WriteRegister(REG_PTR0, (RCS421RegVal)page_table);
   writePageTableEntry(getPageTable1(), (uintptr_t)PAGE_TABLE_0_VADDR, page_table, PROT_READ | PROT_WRITE, PROT_NONE);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  // only the page that maps the region 0 page table has changed in region 1
+  WriteRegister(REG_TLB_FLUSH, (uintptr_t)PAGE_TABLE_0_VADDR);
+  if (next_process->has_kernel_stack)
+    mapKernelStack(next_process->kernel_stack, 0);
   WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
 
   return &next_process->ctx;
-}
\ No newline at end of file
+}
+
+SavedContext *ThreadSwitch(SavedContext *ctxp, void *p1, void *p2)
+{
+  struct pcb *current_process = (pcb *)p1;
+  struct pcb *next_process = (pcb *)p2;
+
+  TracePrintf(2, "ThreadSwitch: switch function is called for %d and %d\n", current_process->pid, next_process->pid);
+
+  // the thread shares the page table, it only needs a copy of the kernel stack
+  // so that it returns from the kernel call just like the current process
+  copyKernelStack(next_process->kernel_stack);
+  setCurrentProcess(next_process);
+  mapKernelStack(next_process->kernel_stack, 1);
+
+  // just continue, but in the new thread
+  return ctxp;
+}
+
+void switchProcess(struct pcb *current_process, struct pcb *next_process)
+{
+  // a process still in a runnable list is preempted, else it has blocked by itself
+  // the idle process is in no list and is not scheduled like the others, so its switches are not counted
+  if (current_process != getIdleProcess())
+  {
+    if (current_process->status == EXECUTION_LIST || current_process->status == RT_LIST)
+      current_process->usage.involuntary_switches++;
+    else
+      current_process->usage.voluntary_switches++;
+  }
+
+  ContextSwitch(NormalSwitch, &current_process->ctx, current_process, next_process);
+}
@@ -8,6 +8,8 @@
 
 // this files stores the switch function for context switch
 
+struct pcb;
+
 // this function really do the context switch
 SavedContext *NormalSwitch(SavedContext *ctxp, void *p1, void *p2);
 
@@ -17,4 +19,12 @@ SavedContext *ForkSwitch(SavedContext *ctxp, void *p1, void *p2);
 // the switch function to Exit the first process and switch to the next process
 SavedContext *ExitSwitch(SavedContext *ctxp, void *p1, void *p2);
 
+// the switch function to start a thread in the address space of the current process
+// the thread continues the execution after switching on a copy of the kernel stack
+SavedContext *ThreadSwitch(SavedContext *ctxp, void *p1, void *p2);
+
+// switch from the current process to the next process, and count the switch as voluntary or involuntary
+// unless the current process is the idle process
+void switchProcess(struct pcb *current_process, struct pcb *next_process);
+
 #endif // YALNIX_SWICH_H
@@ -0,0 +1,198 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sync.h"
+#include "kernel_object.h"
+
+static struct lock locks[MAX_LOCKS];
+static struct cvar cvars[MAX_CVARS];
+
+void initSync()
+{
+  memset(locks, 0, sizeof(locks));
+  memset(cvars, 0, sizeof(cvars));
+  int i;
+  for (i = 0; i < MAX_LOCKS; i++)
+    initWaitQueue(&locks[i].waiters, USAGE_WAIT, 0);
+  for (i = 0; i < MAX_CVARS; i++)
+    initWaitQueue(&cvars[i].waiters, USAGE_WAIT, 0);
+}
+
+// get the lock of the id, NULL if there is no such lock
+static struct lock *getLock(int id)
+{
+  if (OBJECT_TYPE(id) != OBJECT_LOCK || OBJECT_INDEX(id) >= MAX_LOCKS)
+    return NULL;
+  struct lock *lock = &locks[OBJECT_INDEX(id)];
+  if (!lock->in_use || OBJECT_GENERATION(id) != (lock->generation & OBJECT_GENERATION_MASK))
+    return NULL;
+  return lock;
+}
+
+// get the condition variable of the id, NULL if there is no such condition variable
+static struct cvar *getCvar(int id)
+{
+  if (OBJECT_TYPE(id) != OBJECT_CVAR || OBJECT_INDEX(id) >= MAX_CVARS)
+    return NULL;
+  struct cvar *cvar = &cvars[OBJECT_INDEX(id)];
+  if (!cvar->in_use || OBJECT_GENERATION(id) != (cvar->generation & OBJECT_GENERATION_MASK))
+    return NULL;
+  return cvar;
+}
+
+int createLock()
+{
+  int i;
+  for (i = 0; i < MAX_LOCKS; i++)
+    if (!locks[i].in_use)
+    {
+      locks[i].in_use = 1;
+      locks[i].owner = NULL;
+      locks[i].cvar_waiters = 0;
+      return MAKE_OBJECT_ID(OBJECT_LOCK, locks[i].generation, i);
+    }
+  return ERROR;
+}
+
+int acquireLock(int id)
+{
+  struct lock *lock = getLock(id);
+  struct pcb *current_process = getCurrentProcess();
+  if (lock == NULL || lock->owner == current_process)
+    return ERROR;
+
+  if (lock->owner == NULL)
+  {
+    lock->owner = current_process;
+    return 0;
+  }
+
+  // the owner hands the lock to us when it releases it
+  TracePrintf(3, "acquireLock: process %d waits for lock %x held by process %d\n", current_process->pid, id, lock->owner->pid);
+  sleepOn(&lock->waiters);
+  return 0;
+}
+
+// hand the lock to the first waiter, or leave it free
+static void handOverLock(struct lock *lock)
+{
+  lock->owner = wakeOne(&lock->waiters);
+}
+
+int releaseLock(int id)
+{
+  struct lock *lock = getLock(id);
+  if (lock == NULL || lock->owner != getCurrentProcess())
+    return ERROR;
+
+  handOverLock(lock);
+  return 0;
+}
+
+int createCvar()
+{
+  int i;
+  for (i = 0; i < MAX_CVARS; i++)
+    if (!cvars[i].in_use)
+    {
+      cvars[i].in_use = 1;
+      return MAKE_OBJECT_ID(OBJECT_CVAR, cvars[i].generation, i);
+    }
+  return ERROR;
+}
+
+int waitCvar(int cvar_id, int lock_id)
+{
+  struct cvar *cvar = getCvar(cvar_id);
+  struct lock *lock = getLock(lock_id);
+  struct pcb *current_process = getCurrentProcess();
+  if (cvar == NULL || lock == NULL || lock->owner != current_process)
+    return ERROR;
+
+  // signalCvar gives the lock back before it wakes us up
+  current_process->cvar_lock = lock_id;
+  lock->cvar_waiters++;
+  handOverLock(lock);
+  sleepOn(&cvar->waiters);
+  // signalCvar sets it to ERROR if the lock could not be given back
+  return current_process->cvar_lock == ERROR ? ERROR : 0;
+}
+
+int signalCvar(int id, int broadcast)
+{
+  struct cvar *cvar = getCvar(id);
+  if (cvar == NULL)
+    return ERROR;
+
+  struct pcb *waiter;
+  do
+  {
+    waiter = peekWaitQueue(&cvar->waiters);
+    if (waiter == NULL)
+      break;
+
+    struct lock *lock = getLock(waiter->cvar_lock);
+    if (lock == NULL)
+    {
+      // reclaimLock refuses a lock with cvar waiters, so this should not happen
+      // but the waiter must not sleep forever on a lock that is gone
+      TracePrintf(0, "signalCvar: the lock %x of process %d is gone\n", waiter->cvar_lock, waiter->pid);
+      waiter->cvar_lock = ERROR;
+      wakeOne(&cvar->waiters);
+      return ERROR;
+    }
+    lock->cvar_waiters--;
+    waiter->cvar_lock = 0;
+    if (lock->owner == NULL)
+    {
+      // the lock is free, the waiter goes on holding it
+      lock->owner = waiter;
+      wakeOne(&cvar->waiters);
+    }
+    else
+      // the waiter would only block on the lock, so it waits there instead
+      requeueOne(&cvar->waiters, &lock->waiters);
+  } while (broadcast);
+  return 0;
+}
+
+int reclaimLock(int id)
+{
+  struct lock *lock = getLock(id);
+  if (lock == NULL || lock->owner != NULL || lock->cvar_waiters > 0)
+    return ERROR;
+
+  // a lock that nobody holds has no waiters either
+  lock->in_use = 0;
+  lock->generation++;
+  return 0;
+}
+
+int reclaimCvar(int id)
+{
+  struct cvar *cvar = getCvar(id);
+  if (cvar == NULL || !isWaitQueueEmpty(&cvar->waiters))
+    return ERROR;
+
+  cvar->in_use = 0;
+  cvar->generation++;
+  return 0;
+}
+
+void dropLocks(struct pcb *pcb)
+{
+  // a process killed in CvarWait no longer counts against its lock
+  struct lock *cvar_lock = getLock(pcb->cvar_lock);
+  if (cvar_lock != NULL)
+    cvar_lock->cvar_waiters--;
+  pcb->cvar_lock = 0;
+
+  int i;
+  for (i = 0; i < MAX_LOCKS; i++)
+    if (locks[i].in_use && locks[i].owner == pcb)
+    {
+      TracePrintf(1, "dropLocks: process %d exits holding lock %d, handing it over\n", pcb->pid, i);
+      handOverLock(&locks[i]);
+    }
+}
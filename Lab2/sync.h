@@ -0,0 +1,59 @@
+#ifndef YALNIX_SYNC_H
+#define YALNIX_SYNC_H
+#include "pcb.h"
+#include "wait_queue.h"
+// this file manages the locks and condition variables of the user programs
+// a released lock goes straight to its first waiter, so nobody can barge in ahead of the queue
+// and a signaled waiter joins the queue of its lock instead of waking up only to block on it again
+
+// the most locks and condition variables that can exist at the same time
+#define MAX_LOCKS 32
+#define MAX_CVARS 32
+
+struct lock
+{
+  int in_use;
+  int generation;            // bumped when the lock is reclaimed, so its old id no longer reaches the slot
+  struct pcb *owner;         // NULL if the lock is free
+  struct wait_queue waiters; // waiting to acquire, in FIFO order
+  int cvar_waiters;          // processes in CvarWait that get this lock back when signaled
+};
+
+struct cvar
+{
+  int in_use;
+  int generation;            // bumped when the condition variable is reclaimed, like the one of a lock
+  struct wait_queue waiters; // waiting to be signaled, in FIFO order
+};
+
+// initialize the tables of locks and condition variables
+void initSync();
+
+// create a lock, return its id or ERROR if the table is full
+int createLock();
+
+// acquire the lock, blocking until the current owner hands it over
+// return ERROR if there is no such lock or the current process holds it already
+int acquireLock(int id);
+
+// release the lock held by the current process, handing it to the first waiter if there is one
+int releaseLock(int id);
+
+// create a condition variable, return its id or ERROR if the table is full
+int createCvar();
+
+// release the lock and wait for a signal, the lock is held again on return
+int waitCvar(int cvar_id, int lock_id);
+
+// let the first waiter go on, or every waiter with broadcast
+int signalCvar(int id, int broadcast);
+
+// free the lock or condition variable, return ERROR if it is in use
+// a lock is in use while a process waiting on a condition variable is to get it back
+int reclaimLock(int id);
+int reclaimCvar(int id);
+
+// release every lock held by the exiting process, and forget the lock it waits to get back from a condition variable
+void dropLocks(struct pcb *pcb);
+
+#endif // YALNIX_SYNC_H
@@ -3,7 +3,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "terminal.h"
+#include "kernel_call.h"
 #include "tty_buffer.h"
+#include "pcb.h"
+#include "pte.h"
+#include "page.h"
 
 // keep track of the status for tranmitting each terminal
 static int *terminal_transmit_status = NULL;
@@ -12,11 +16,50 @@ static int *terminal_transmit_status = NULL;
 static tty_buf **tty_receive_buf = NULL;
 static tty_buf **tty_transmit_buf = NULL;
 
+// the processes blocked on each terminal
+static struct wait_queue tty_read_queue[NUM_TERMINALS];
+static struct wait_queue tty_write_queue[NUM_TERMINALS];
+static struct wait_queue tty_transmit_queue[NUM_TERMINALS];
+static struct wait_queue tty_drain_queue[NUM_TERMINALS];
+static struct wait_queue tty_poll_queue[NUM_TERMINALS];
+
+// the line being transmitted from the ring, a full TERMINAL_MAX_LINE even if the ring wraps around
+static char tty_line[NUM_TERMINALS][TERMINAL_MAX_LINE];
+
+// the line the terminal has just received when the free space of the ring wraps around
+// kept here so the interrupt handler never allocates
+static char tty_received_line[NUM_TERMINALS][TERMINAL_MAX_LINE];
+
+// the counters of the ring output, the writes beyond the transmits are the interrupts saved by coalescing
+static int tty_writes[NUM_TERMINALS];
+static int tty_transmits[NUM_TERMINALS];
+static int tty_transmit_bytes[NUM_TERMINALS];
+
+// the counters of the ring input, an overrun is a received line that did not fit as it was
+static int tty_received_lines[NUM_TERMINALS];
+static int tty_received_bytes[NUM_TERMINALS];
+static int tty_staged_lines[NUM_TERMINALS];
+static int tty_overruns[NUM_TERMINALS];
+static int tty_dropped_lines[NUM_TERMINALS];
+static int tty_dropped_bytes[NUM_TERMINALS];
+
+// the line discipline of each terminal, set by TtySetMode
+static int tty_mode[NUM_TERMINALS];
+static int tty_min[NUM_TERMINALS];
+static int tty_timeout[NUM_TERMINALS];
+
+// the process that owns each terminal for writing, NULL if nobody
+static struct pcb *tty_writer[NUM_TERMINALS];
+
+// the physical pages of the user line each terminal is transmitting
+static uintptr_t tty_pinned[NUM_TERMINALS][TTY_WINDOW_PAGES];
+static int tty_pinned_count[NUM_TERMINALS];
+
 void initTerminals()
 {
     terminal_transmit_status = malloc(NUM_TERMINALS * sizeof(int));
 
-    // assign a buf inside region 1 of TERMINAL_MAX_LINE bytes to store the chars received by each terminal
+    // both rings of each terminal are allocated here once, so the memory of a terminal is fixed
     tty_receive_buf = (tty_buf **)malloc(NUM_TERMINALS * sizeof(tty_buf *));
     tty_transmit_buf = (tty_buf **)malloc(NUM_TERMINALS * sizeof(tty_buf *));
 
@@ -24,8 +67,28 @@ void initTerminals()
     for (i = 0; i < NUM_TERMINALS; i++)
     {
         terminal_transmit_status[i] = IDLE;
-        tty_receive_buf[i] = createBuffer();
-        tty_transmit_buf[i] = createBuffer();
+        tty_receive_buf[i] = createBuffer(TTY_RECEIVE_RING_SIZE, 1);
+        tty_transmit_buf[i] = createBuffer(TTY_TRANSMIT_RING_SIZE, 0);
+        initWaitQueue(&tty_read_queue[i], USAGE_TTY_READ, 0);
+        initWaitQueue(&tty_write_queue[i], USAGE_TTY_WRITE, 0);
+        initWaitQueue(&tty_transmit_queue[i], USAGE_TTY_WRITE, 0);
+        initWaitQueue(&tty_drain_queue[i], USAGE_TTY_WRITE, 0);
+        initWaitQueue(&tty_poll_queue[i], USAGE_WAIT, 0);
+        tty_writes[i] = 0;
+        tty_transmits[i] = 0;
+        tty_transmit_bytes[i] = 0;
+        tty_received_lines[i] = 0;
+        tty_received_bytes[i] = 0;
+        tty_staged_lines[i] = 0;
+        tty_overruns[i] = 0;
+        tty_dropped_lines[i] = 0;
+        tty_dropped_bytes[i] = 0;
+        tty_writer[i] = NULL;
+        tty_mode[i] = TTY_MODE_CANONICAL;
+        tty_receive_buf[i]->eol = TTY_EOF_CHAR;
+        tty_min[i] = 1;
+        tty_timeout[i] = 0;
+        tty_pinned_count[i] = 0;
     }
 }
 
@@ -49,3 +112,300 @@ void setTerminalTransmitStatus(int tty_id, enum TTY_STATUS status)
     terminal_transmit_status[tty_id] = status;
 }
 
+struct wait_queue *getTtyReadQueue(int tty_id)
+{
+    return &tty_read_queue[tty_id];
+}
+
+struct wait_queue *getTtyTransmitQueue(int tty_id)
+{
+    return &tty_transmit_queue[tty_id];
+}
+
+void acquireTtyWriter(int tty_id)
+{
+    struct pcb *current_process = getCurrentProcess();
+    if (tty_writer[tty_id] == NULL && isWaitQueueEmpty(&tty_write_queue[tty_id]))
+    {
+        tty_writer[tty_id] = current_process;
+        return;
+    }
+
+    // releaseTtyWriter hands the terminal to us directly, so nobody can take it in between
+    TracePrintf(3, "acquireTtyWriter: process %d waits for terminal %d held by process %d\n", current_process->pid, tty_id, tty_writer[tty_id] == NULL ? -1 : tty_writer[tty_id]->pid);
+    sleepOn(&tty_write_queue[tty_id]);
+}
+
+void releaseTtyWriter(int tty_id)
+{
+    tty_writer[tty_id] = wakeOne(&tty_write_queue[tty_id]);
+    if (tty_writer[tty_id] == NULL)
+        wakeAll(&tty_poll_queue[tty_id]);
+}
+
+void dropTtyWriter(struct pcb *pcb)
+{
+    int i;
+    for (i = 0; i < NUM_TERMINALS; i++)
+        if (tty_writer[i] == pcb)
+            releaseTtyWriter(i);
+}
+
+int transmitUserLine(int tty_id, void *buf, int len)
+{
+    // the kernel messages are already in region 1
+    if ((uintptr_t)buf >= VMEM_1_BASE)
+    {
+        TtyTransmit(tty_id, buf, len);
+        return 0;
+    }
+
+    struct pte *page_table_0_vaddr = PAGE_TABLE_0_VADDR;
+    uintptr_t first_page = DOWN_TO_PAGE(buf);
+    uintptr_t last_page = DOWN_TO_PAGE((uintptr_t)buf + len - 1);
+    uintptr_t window = TTY_WINDOW_VADDR(tty_id);
+    uintptr_t page;
+    if (!isUserBuffer((uintptr_t)buf, len, PROT_READ))
+    {
+        TracePrintf(0, "transmitUserLine: a page of the buffer at 0x%x is gone\n", buf);
+        return ERROR;
+    }
+
+    int i = 0;
+    for (page = first_page; page <= last_page; page += PAGESIZE, i++)
+    {
+        uintptr_t physical_address = page_table_0_vaddr[page >> PAGESHIFT].pfn << PAGESHIFT;
+        pinPage(physical_address);
+        tty_pinned[tty_id][i] = physical_address;
+        writePageTableEntry(getPageTable1(), window + (i << PAGESHIFT), physical_address, PROT_READ, PROT_NONE);
+        WriteRegister(REG_TLB_FLUSH, window + (i << PAGESHIFT));
+    }
+    tty_pinned_count[tty_id] = i;
+
+    TtyTransmit(tty_id, (void *)(window + ((uintptr_t)buf & PAGEOFFSET)), len);
+    return 0;
+}
+
+int setTtyMode(int tty_id, int mode, int min, int timeout)
+{
+    if (mode != TTY_MODE_CANONICAL && mode != TTY_MODE_RAW)
+        return ERROR;
+    if (min < 0 || min > TTY_RECEIVE_RING_SIZE || timeout < 0)
+        return ERROR;
+
+    tty_mode[tty_id] = mode;
+    tty_min[tty_id] = min;
+    tty_timeout[tty_id] = timeout;
+    // the chars received from now on are indexed for the new mode, the ones already in the ring keep their lines
+    tty_receive_buf[tty_id]->eol = mode == TTY_MODE_CANONICAL ? TTY_EOF_CHAR : 0;
+    return 0;
+}
+
+int getTtyMode(int tty_id, int *min, int *timeout)
+{
+    *min = tty_min[tty_id];
+    *timeout = tty_timeout[tty_id];
+    return tty_mode[tty_id];
+}
+
+int readTtyLine(int tty_id, void *buf, int len)
+{
+    len = getBuf(tty_receive_buf[tty_id], buf, len, 1);
+    if (len > 0 && ((char *)buf)[len - 1] == TTY_EOF_CHAR)
+        len--;
+    return len;
+}
+
+// apply the erase, kill and EOF chars of canonical mode to the len chars just received, in place
+// they only reach back to the start of the line being received, return the number of chars left
+static int editTtyLine(char *line, int len)
+{
+    int line_start = 0;
+    int edited_len = 0;
+    int i;
+    for (i = 0; i < len; i++)
+    {
+        char c = line[i];
+        if (c == TTY_ERASE_CHAR || c == TTY_DELETE_CHAR)
+        {
+            if (edited_len > line_start)
+                edited_len--;
+            continue;
+        }
+        if (c == TTY_KILL_CHAR)
+        {
+            edited_len = line_start;
+            continue;
+        }
+
+        line[edited_len++] = c;
+        if (c == '\n' || c == TTY_EOF_CHAR)
+            line_start = edited_len;
+    }
+    return edited_len;
+}
+
+void receiveTtyLine(int tty_id)
+{
+    tty_buf *ring = tty_receive_buf[tty_id];
+    tty_received_lines[tty_id]++;
+
+    // the longest line fits at the end of the ring, so it needs no copy and no overflow policy
+    void *space = reserveBuf(ring, TERMINAL_MAX_LINE);
+    if (space != NULL)
+    {
+        int len = TtyReceive(tty_id, space, TERMINAL_MAX_LINE);
+        tty_received_bytes[tty_id] += len;
+        if (tty_mode[tty_id] == TTY_MODE_CANONICAL)
+            len = editTtyLine(space, len);
+        commitBuf(ring, len);
+        TracePrintf(3, "receiveTtyLine: received %d chars into the receive ring of terminal %d, %d chars in it now\n", len, tty_id, ring->size);
+        return;
+    }
+
+    char *line = tty_received_line[tty_id];
+    int len = TtyReceive(tty_id, line, TERMINAL_MAX_LINE);
+    tty_received_bytes[tty_id] += len;
+    tty_staged_lines[tty_id]++;
+    if (tty_mode[tty_id] == TTY_MODE_CANONICAL)
+        len = editTtyLine(line, len);
+
+    if (len > freeSpace(ring))
+    {
+        tty_overruns[tty_id]++;
+#if TTY_OVERFLOW_POLICY == TTY_DROP_OLDEST
+        // a line is at most TERMINAL_MAX_LINE chars, so this drops only a few lines
+        while (len > freeSpace(ring))
+        {
+            int dropped = getLineLength(ring);
+            dropBuf(ring, dropped);
+            tty_dropped_lines[tty_id]++;
+            tty_dropped_bytes[tty_id] += dropped;
+        }
+#elif TTY_OVERFLOW_POLICY == TTY_DROP_NEWEST
+        tty_dropped_lines[tty_id]++;
+        tty_dropped_bytes[tty_id] += len;
+        TracePrintf(1, "receiveTtyLine: receive ring of terminal %d is full, dropped a line of %d chars\n", tty_id, len);
+        return;
+#else
+        tty_dropped_bytes[tty_id] += len - freeSpace(ring);
+#endif
+        TracePrintf(1, "receiveTtyLine: receive ring of terminal %d overran %d times, %d chars lost so far\n", tty_id, tty_overruns[tty_id], tty_dropped_bytes[tty_id]);
+    }
+
+    len = addBuf(ring, line, len);
+    TracePrintf(3, "receiveTtyLine: added %d chars to the receive ring of terminal %d, %d chars in it now\n", len, tty_id, ring->size);
+}
+
+void getTtyStats(int tty_id, struct tty_stats *stats)
+{
+    stats->received_lines = tty_received_lines[tty_id];
+    stats->received_bytes = tty_received_bytes[tty_id];
+    stats->staged_lines = tty_staged_lines[tty_id];
+    stats->unread_bytes = tty_receive_buf[tty_id]->size;
+    stats->overruns = tty_overruns[tty_id];
+    stats->dropped_lines = tty_dropped_lines[tty_id];
+    stats->dropped_bytes = tty_dropped_bytes[tty_id];
+    stats->writes = tty_writes[tty_id];
+    stats->transmits = tty_transmits[tty_id];
+    stats->transmit_bytes = tty_transmit_bytes[tty_id];
+}
+
+// start transmitting the next line from the ring, if the terminal is idle
+// everything queued since the last transmit goes out together, up to TERMINAL_MAX_LINE chars
+static void transmitFromRing(int tty_id)
+{
+    if (terminal_transmit_status[tty_id] == BUSY)
+        return;
+
+    int len = getBuf(tty_transmit_buf[tty_id], tty_line[tty_id], TERMINAL_MAX_LINE, 0);
+    if (len == 0)
+        return;
+
+    TtyTransmit(tty_id, tty_line[tty_id], len);
+    terminal_transmit_status[tty_id] = BUSY;
+
+    tty_transmits[tty_id]++;
+    tty_transmit_bytes[tty_id] += len;
+    TracePrintf(3, "transmitFromRing: terminal %d transmits %d chars, %d chars in %d transmits for %d writes so far\n", tty_id, len, tty_transmit_bytes[tty_id], tty_transmits[tty_id], tty_writes[tty_id]);
+}
+
+int queueTtyOutput(int tty_id, void *buf, int len)
+{
+    tty_buf *ring = tty_transmit_buf[tty_id];
+    tty_writes[tty_id]++;
+    while (1)
+    {
+        int space = TTY_TRANSMIT_RING_SIZE - ring->size;
+        int queue_len = len < space ? len : space;
+        addBuf(ring, buf, queue_len);
+        buf += queue_len;
+        len -= queue_len;
+
+        transmitFromRing(tty_id);
+        if (len == 0)
+            return 0;
+
+        // every finished line makes room in the ring
+        TracePrintf(3, "queueTtyOutput: transmit ring of terminal %d is full, blocking the writing process with pid=%d\n", tty_id, getCurrentProcess()->pid);
+        sleepOn(&tty_transmit_queue[tty_id]);
+        if (!isUserBuffer((uintptr_t)buf, len, PROT_READ))
+        {
+            TracePrintf(0, "queueTtyOutput: the rest of the buffer of process %d is gone\n", getCurrentProcess()->pid);
+            return ERROR;
+        }
+    }
+}
+
+void finishTtyTransmit(int tty_id)
+{
+    terminal_transmit_status[tty_id] = IDLE;
+
+    // the pages of a user line may be freed now, even if the writer has been killed meanwhile
+    int i;
+    for (i = 0; i < tty_pinned_count[tty_id]; i++)
+        unpinPage(tty_pinned[tty_id][i]);
+    tty_pinned_count[tty_id] = 0;
+
+    transmitFromRing(tty_id);
+}
+
+int isTtyDrained(int tty_id)
+{
+    return terminal_transmit_status[tty_id] == IDLE && isEmpty(tty_transmit_buf[tty_id]);
+}
+
+struct wait_queue *getTtyDrainQueue(int tty_id)
+{
+    return &tty_drain_queue[tty_id];
+}
+
+int isTtyReadable(int tty_id)
+{
+    tty_buf *ring = tty_receive_buf[tty_id];
+    if (tty_mode[tty_id] == TTY_MODE_CANONICAL)
+        return !isEmpty(ring);
+    // a raw read with no min returns at once anyway, so there must be a char for it to count
+    return ring->size > 0 && ring->size >= tty_min[tty_id];
+}
+
+int isTtyWritable(int tty_id)
+{
+    return tty_writer[tty_id] == NULL && isWaitQueueEmpty(&tty_write_queue[tty_id]) && freeSpace(tty_transmit_buf[tty_id]) > 0;
+}
+
+int tryQueueTtyOutput(int tty_id, void *buf, int len)
+{
+    if (!isTtyWritable(tty_id))
+        return 0;
+
+    tty_writes[tty_id]++;
+    len = addBuf(tty_transmit_buf[tty_id], buf, len);
+    transmitFromRing(tty_id);
+    return len;
+}
+
+struct wait_queue *getTtyPollQueue(int tty_id)
+{
+    return &tty_poll_queue[tty_id];
+}
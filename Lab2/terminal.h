@@ -3,6 +3,7 @@
 #include <comp421/hardware.h>
 #include <comp421/yalnix.h>
 #include "tty_buffer.h"
+#include "wait_queue.h"
 // this file stores the functions for terminal initialization
 
 enum TTY_STATUS
@@ -23,5 +24,92 @@ int getTerminalTransmitStatus(int tty_id);
 
 void setTerminalTransmitStatus(int tty_id, enum TTY_STATUS status);
 
+struct pcb;
+struct tty_stats;
+
+// the most chars waiting in the transmit ring of a terminal, a write longer than this is not copied
+// but transmitted straight from the writer's pages (see transmitUserLine)
+#define TTY_TRANSMIT_RING_SIZE 1024
+
+// the chars each terminal keeps for its readers, allocated once at boot and never grown
+// a few lines long, so there is usually TERMINAL_MAX_LINE contiguous room for TtyReceive to write into
+#define TTY_RECEIVE_RING_SIZE 4096
+
+// what onTrapTTYReceive does with a line that does not fit in the receive ring
+#define TTY_DROP_OLDEST 0   // make room by dropping the oldest lines nobody has read
+#define TTY_DROP_NEWEST 1   // drop the new line, the lines already queued are kept whole
+#define TTY_COUNT_OVERRUN 2 // keep what fits of the new line and count the chars lost
+
+#define TTY_OVERFLOW_POLICY TTY_DROP_OLDEST
+
+// receive the line of the terminal straight into its receive ring if there is contiguous room
+// otherwise receive it into a static staging line and copy it, applying TTY_OVERFLOW_POLICY if it is full
+// never calls malloc, as it runs in the receive interrupt
+void receiveTtyLine(int tty_id);
+
+// set the line discipline of the terminal, see TtySetMode, return ERROR if the arguments are invalid
+int setTtyMode(int tty_id, int mode, int min, int timeout);
+
+// get the line discipline of the terminal, and the min and timeout of TTY_MODE_RAW
+int getTtyMode(int tty_id, int *min, int *timeout);
+
+// take the next line (at most len chars of it) from the receive ring, for a read in TTY_MODE_CANONICAL
+// the TTY_EOF_CHAR that ends a line is not delivered, so an empty line ended by it reads as 0 chars
+int readTtyLine(int tty_id, void *buf, int len);
+
+// would a TtyRead of the terminal return without blocking, by its line discipline
+int isTtyReadable(int tty_id);
+
+// would a TtyWrite of the terminal queue some chars without blocking
+int isTtyWritable(int tty_id);
+
+// queue as much of the buffer as fits in the transmit ring without blocking, for a TTY_NONBLOCK write
+// return the number of chars queued, 0 if the ring is full or another process is writing
+int tryQueueTtyOutput(int tty_id, void *buf, int len);
+
+// the processes in Poll wait here for the terminal to become readable or writable, they are all woken up
+struct wait_queue *getTtyPollQueue(int tty_id);
+
+// fill the counters of the terminal, returned by TtyGetStats
+void getTtyStats(int tty_id, struct tty_stats *stats);
+
+// copy the buffer of the current process into the transmit ring of the terminal
+// start transmitting if the terminal is idle, and block while the ring is full
+// the lines of the ring are coalesced, so the writes that pile up behind a busy terminal share a TtyTransmit
+// return 0, or ERROR if the rest of the buffer went away while the ring was full
+int queueTtyOutput(int tty_id, void *buf, int len);
+
+// called when the terminal has finished transmitting
+// drop the pins of the finished line, and start the next line from the ring
+void finishTtyTransmit(int tty_id);
+
+// is the terminal idle with nothing left in its ring
+int isTtyDrained(int tty_id);
+
+// the processes in TtyDrain wait here for the terminal to become drained
+struct wait_queue *getTtyDrainQueue(int tty_id);
+
+// the readers waiting for a line from the terminal, woken up in FIFO order
+struct wait_queue *getTtyReadQueue(int tty_id);
+
+// the writer of the terminal waits here for the line being transmitted to finish, or for room in the ring
+struct wait_queue *getTtyTransmitQueue(int tty_id);
+
+// transmit len chars (at most TERMINAL_MAX_LINE) from the buffer of the current process
+// a user buffer is not copied, its pages are mapped into the window of the terminal
+// and pinned until the transmit-complete interrupt calls unpinTtyTransmit
+// the writer sleeps between lines, so the pages are checked again here, return ERROR if one has gone
+int transmitUserLine(int tty_id, void *buf, int len);
+
+// make the current process the only writer of the terminal until releaseTtyWriter
+// the writers get the terminal in the order they asked for it, so their lines never interleave
+void acquireTtyWriter(int tty_id);
+
+// hand the terminal over to the next writer in line
+void releaseTtyWriter(int tty_id);
+
+// give up every terminal the process is writing to, used when it is killed in the middle of a write
+void dropTtyWriter(struct pcb *pcb);
+
 #endif // YALNIX_TERMINAL_H
 
@@ -0,0 +1,19 @@
+#ifndef YALNIX_TEST_CHECK_H
+#define YALNIX_TEST_CHECK_H
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+// this file has the checks shared by the test programs
+// a failed check is traced at level 0 and ends the calling process with status 1
+// so a check in a child shows up in its exit status for the parent to check in turn
+
+#define CHECK(cond)                                                                          \
+  do                                                                                         \
+  {                                                                                          \
+    if (!(cond))                                                                             \
+    {                                                                                        \
+      TracePrintf(0, "testProcess: check failed at %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+      Exit(1);                                                                               \
+    }                                                                                        \
+  } while (0)
+
+#endif // YALNIX_TEST_CHECK_H
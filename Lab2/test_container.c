@@ -0,0 +1,47 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  struct container_usage usage;
+
+  if (Fork() == 0)
+  {
+    // a runaway tenant, limited to 40 frames and a quarter of the cpu
+    int id = ContainerCreate(40, 5);
+    TracePrintf(4, "testProcess: created container %d\n", id);
+
+    // a process in a container can not hand out new limits
+    TracePrintf(4, "testProcess: nested ContainerCreate returned %d\n", ContainerCreate(0, 0));
+
+    // fork until the container runs out of frames
+    while (Fork() != ERROR)
+      ;
+
+    ContainerUsage(-1, &usage);
+    TracePrintf(4, "testProcess: container %d holds %d/%d frames with %d processes\n", usage.id, usage.frames, usage.frame_limit, usage.processes);
+
+    while (1)
+      ;
+  }
+
+  // we still get our share of the cpu and memory
+  int i;
+  for (i = 0; i < 10; i++)
+  {
+    Delay(5);
+    if (ContainerUsage(1, &usage) == 0)
+      TracePrintf(4, "testProcess: container %d ran %d ticks and was throttled %d times\n", usage.id, usage.cpu_ticks, usage.throttled);
+  }
+
+  void *p = malloc(10 * PAGESIZE);
+  TracePrintf(4, "testProcess: the root container can still malloc: %p\n", p);
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int i;
+  // a few cpu bound processes to load the round robin list
+  for (i = 0; i < 3; i++)
+  {
+    if (Fork() == 0)
+    {
+      while (1)
+        ;
+    }
+  }
+
+  // this is too much for anyone, it must be rejected
+  TracePrintf(4, "testProcess: SetDeadline(2, 3) returned %d\n", SetDeadline(2, 3));
+
+  if (SetDeadline(4, 1) == ERROR)
+  {
+    TracePrintf(0, "testProcess: SetDeadline(4, 1) is rejected\n");
+    Exit(ERROR);
+  }
+
+  // another process asking for all of a period would take the total above 1
+  int pid = Fork();
+  if (pid == 0)
+  {
+    TracePrintf(4, "testProcess: SetDeadline(4, 4) in a second process returned %d\n", SetDeadline(4, 4));
+    // what is left still fits
+    TracePrintf(4, "testProcess: SetDeadline(4, 3) in a second process returned %d\n", SetDeadline(4, 3));
+    Exit(0);
+  }
+  int status;
+  WaitPid(pid, &status, 0, 0, NULL);
+
+  // the periodic sampler, it shall wake up on time even with the cpu bound processes around
+  for (i = 0; i < 20; i++)
+  {
+    TracePrintf(4, "testProcess: sample %d\n", i);
+    Delay(4);
+  }
+
+  struct process_usage usage;
+  GetUsage(0, &usage);
+  TracePrintf(4, "testProcess: missed %d out of %d deadlines\n", usage.rt_misses, usage.rt_periods);
+  Exit(0);
+}
@@ -0,0 +1,100 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "umutex.h"
+#include "test_check.h"
+
+#define THREADS 4
+#define THREAD_STACK_SIZE (4 * PAGESIZE)
+// the increments of each thread, each one sleeps inside the mutex
+#define INCREMENTS 5
+
+// shared by all the threads
+umutex mutex = UMUTEX_INITIALIZER;
+int counter = 0;
+volatile int word = 0;
+int wakeups = 0;
+
+void *newStack()
+{
+  return (char *)malloc(THREAD_STACK_SIZE) + THREAD_STACK_SIZE;
+}
+
+// increment the counter, losing increments unless the mutex keeps the others out
+void increment(void *arg)
+{
+  int i;
+  for (i = 0; i < INCREMENTS; i++)
+  {
+    umutexLock(&mutex);
+    int value = counter;
+    Delay(1);
+    counter = value + 1;
+    umutexUnlock(&mutex);
+  }
+  ThreadExit((int)arg);
+}
+
+// wait until the word is set, counting the wakeups
+void awaitWord(void *arg)
+{
+  while (word == 0)
+  {
+    CHECK(FutexWait((int *)&word, 0, 0) == 0);
+    __sync_fetch_and_add(&wakeups, 1);
+  }
+  ThreadExit((int)arg);
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  // a word that changed is not waited on, and a timed wait runs out when nobody wakes it
+  int local = 1;
+  CHECK(FutexWait(&local, 0, 0) == 0);
+  CHECK(FutexWait(&local, 1, 3) == FUTEX_TIMED_OUT);
+  CHECK(FutexWake(&local, 1) == 0);
+  CHECK(FutexWake(&local, 0) == 0);
+  CHECK(FutexWait(NULL, 0, 0) == ERROR);
+  CHECK(FutexWait((int *)((char *)&local + 1), 0, 0) == ERROR);
+  CHECK(FutexWake((int *)USER_STACK_LIMIT, 1) == ERROR);
+
+  // FutexWake wakes no more than count waiters, and says how many it woke
+  int i, status;
+  int tids[THREADS];
+  for (i = 0; i < THREADS; i++)
+    tids[i] = ThreadCreate(awaitWord, (void *)i, newStack());
+  // let all of them fall asleep
+  Delay(2);
+  CHECK(FutexWake((int *)&word, 2) == 2);
+  Delay(2);
+  CHECK(wakeups == 2);
+  word = 1;
+  CHECK(FutexWake((int *)&word, THREADS + 1) == THREADS);
+  for (i = 0; i < THREADS; i++)
+    CHECK(ThreadJoin(tids[i], &status) == 0 && status == i);
+  CHECK(wakeups == THREADS + 2);
+  CHECK(FutexWake((int *)&word, 1) == 0);
+
+  // a held mutex cannot be taken
+  CHECK(umutexTryLock(&mutex));
+  CHECK(!umutexTryLock(&mutex));
+  umutexUnlock(&mutex);
+  CHECK(mutex.word == UMUTEX_FREE);
+
+  // no increment is lost, and the mutex ends up free with nobody waiting
+  for (i = 0; i < THREADS; i++)
+    tids[i] = ThreadCreate(increment, (void *)i, newStack());
+  for (i = 0; i < THREADS; i++)
+    CHECK(ThreadJoin(tids[i], &status) == 0 && status == i);
+  CHECK(counter == THREADS * INCREMENTS);
+  CHECK(mutex.word == UMUTEX_FREE);
+  CHECK(FutexWake(&mutex.word, 1) == 0);
+
+  TracePrintf(4, "testProcess: futex checks passed\n");
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+#define SERVICE 1
+// the payload of the bulk requests, several pages
+#define PAYLOAD (4 * PAGESIZE)
+
+// the ops of the test server
+#define OP_ADD 0 // add one to value
+#define OP_REVERSE 1 // read the payload at buf and write it back reversed
+#define OP_BAD_COPY 2 // set value to 1 if copies outside the sender fail
+#define OP_NO_REPLY 3 // never reply
+
+// the message of the test server, MESSAGE_SIZE bytes
+struct request
+{
+  int op;
+  int value;
+  char *buf;
+  int len;
+  char padding[MESSAGE_SIZE - 3 * sizeof(int) - sizeof(char *)];
+};
+
+static void serve()
+{
+  char *payload = malloc(PAYLOAD);
+  struct request request;
+  while (1)
+  {
+    int pid = Receive(&request);
+    CHECK(pid > 0);
+    if (request.op == OP_NO_REPLY)
+      continue;
+    if (request.op == OP_REVERSE)
+    {
+      CHECK(CopyFrom(pid, payload, request.buf, request.len) == 0);
+      int i;
+      for (i = 0; i < request.len / 2; i++)
+      {
+        char c = payload[i];
+        payload[i] = payload[request.len - 1 - i];
+        payload[request.len - 1 - i] = c;
+      }
+      CHECK(CopyTo(pid, request.buf, payload, request.len) == 0);
+    }
+    if (request.op == OP_BAD_COPY)
+    {
+      // a length past the end of the user space, a negative one, a range over the stack limit
+      request.value = CopyFrom(pid, payload, request.buf, 0x7fffffff) == ERROR &&
+                      CopyFrom(pid, payload, request.buf, -1) == ERROR &&
+                      CopyTo(pid, (char *)USER_STACK_LIMIT - 8, payload, 16) == ERROR;
+      // the server only answers the one that sent
+      CHECK(Reply(&request, GetPid()) == ERROR);
+    }
+    else
+      request.value++;
+    CHECK(Reply(&request, pid) == 0);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int server = Fork();
+  if (server == 0)
+  {
+    CHECK(Register(SERVICE) == 0);
+    serve();
+  }
+  // let the server register before the first request
+  Delay(1);
+
+  struct request request;
+  CHECK(Register(SERVICE) == ERROR);
+  CHECK(Register(0) == ERROR);
+  CHECK(Send(&request, GetPid()) == ERROR);
+  CHECK(Send(&request, -(SERVICE + 1)) == ERROR);
+
+  // the reply overwrites the message
+  int i;
+  for (i = 0; i < 10; i++)
+  {
+    request.op = OP_ADD;
+    request.value = i;
+    CHECK(Send(&request, -SERVICE) == 0 && request.value == i + 1);
+  }
+  request.op = OP_ADD;
+  request.value = 41;
+  CHECK(Send(&request, server) == 0 && request.value == 42);
+
+  // the server copies a payload of several pages out of the sender and back
+  char *payload = malloc(PAYLOAD);
+  for (i = 0; i < PAYLOAD; i++)
+    payload[i] = (char)i;
+  request.op = OP_REVERSE;
+  request.buf = payload;
+  request.len = PAYLOAD;
+  CHECK(Send(&request, -SERVICE) == 0);
+  for (i = 0; i < PAYLOAD; i++)
+    CHECK(payload[i] == (char)(PAYLOAD - 1 - i));
+
+  request.op = OP_BAD_COPY;
+  request.buf = payload;
+  CHECK(Send(&request, -SERVICE) == 0 && request.value == 1);
+
+  // a sender left waiting for a reply gets ERROR once the server is killed
+  int status;
+  int sender = Fork();
+  if (sender == 0)
+  {
+    request.op = OP_NO_REPLY;
+    Exit(Send(&request, -SERVICE) == ERROR ? 0 : 1);
+  }
+  Delay(2);
+  CHECK(Kill(server) == 0);
+  CHECK(WaitPid(sender, &status, 0, 0, NULL) == sender && status == 0);
+  CHECK(WaitPid(server, &status, 0, 0, NULL) == server);
+
+  // the service is free again
+  request.op = OP_ADD;
+  CHECK(Send(&request, -SERVICE) == ERROR);
+  CHECK(Register(SERVICE) == 0);
+
+  free(payload);
+  TracePrintf(4, "testProcess: ipc checks passed\n");
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+// the children of the group, every child has one grandchild in the group too
+#define CHILDREN 4
+
+// sleep until killed
+void sleeper()
+{
+  Delay(100000);
+  Exit(0);
+}
+
+// a child sleeps in Delay, with a grandchild it blocks in Wait
+void child(int grandchild)
+{
+  // let the parent put us into the group before we fork
+  Delay(1);
+  if (grandchild && Fork() == 0)
+    sleeper();
+  int status;
+  if (Wait(&status) == ERROR)
+    sleeper();
+  Exit(0);
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int status;
+
+  // a single kill, the parent collects EXIT_KILLED
+  int pid = Fork();
+  if (pid == 0)
+    sleeper();
+  CHECK(Kill(pid) == 0);
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == EXIT_KILLED);
+  CHECK(Kill(pid) == ERROR);
+
+  // a tree in a new group named by the first child, KillGroup ends the children and the grandchildren
+  int pids[CHILDREN];
+  int pgid = 0;
+  int i;
+  for (i = 0; i < CHILDREN; i++)
+  {
+    pids[i] = Fork();
+    if (pids[i] == 0)
+      child(1);
+    pgid = SetPgid(pids[i], pgid);
+    CHECK(pgid == pids[0]);
+  }
+  // make sure all the grandchildren are there
+  Delay(2);
+  int killed = KillGroup(pgid);
+  TracePrintf(4, "testProcess: KillGroup(%d) killed %d processes\n", pgid, killed);
+  CHECK(killed == 2 * CHILDREN);
+  for (i = 0; i < CHILDREN; i++)
+    CHECK(WaitPid(pids[i], &status, 0, 0, NULL) == pids[i] && status == EXIT_KILLED);
+  CHECK(KillGroup(pgid) == 0);
+
+  // a process may not kill its sibling, nor join its group
+  int sibling = Fork();
+  if (sibling == 0)
+    sleeper();
+  CHECK(SetPgid(sibling, 0) == sibling);
+  pid = Fork();
+  if (pid == 0)
+  {
+    CHECK(Kill(sibling) == ERROR);
+    CHECK(SetPgid(0, sibling) == ERROR);
+    // nor name a group after a pid that does not lead one
+    CHECK(SetPgid(0, GetPid() + 1000) == ERROR);
+    CHECK(SetPgid(0, 0) == GetPid());
+    Exit(0);
+  }
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == 0);
+
+  // a process in the group of its sibling ends itself with KillGroup, but not the sibling
+  pid = Fork();
+  if (pid == 0)
+  {
+    Delay(1);
+    KillGroup(0);
+    Exit(1);
+  }
+  CHECK(SetPgid(pid, sibling) == sibling);
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == EXIT_KILLED);
+  CHECK(Kill(sibling) == 0);
+  CHECK(WaitPid(sibling, &status, 0, 0, NULL) == sibling && status == EXIT_KILLED);
+
+  TracePrintf(4, "testProcess: kill checks passed\n");
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "kinfo.h"
+#include "test_check.h"
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int pid = GetPid();
+  CHECK(kinfoPid() == pid);
+
+  // the page follows the dispatch, the child sees itself and its parent
+  int status;
+  int child = Fork();
+  if (child == 0)
+  {
+    CHECK(kinfoPid() == GetPid());
+    CHECK(kinfoPpid() == pid);
+    Exit(0);
+  }
+  CHECK(kinfoPid() == pid);
+  CHECK(WaitPid(child, &status, 0, 0, NULL) == child && status == 0);
+  CHECK(kinfoPid() == pid);
+
+  // the page is read-only, writing it kills the process
+  child = Fork();
+  if (child == 0)
+  {
+    ((struct kernel_info *)KERNEL_INFO_VADDR)->pid = 0;
+    Exit(0);
+  }
+  CHECK(WaitPid(child, &status, 0, 0, NULL) == child && status == ERROR);
+  CHECK(kinfoPid() == pid);
+
+  // the clock moves while we sleep, and every sleep is a switch away and back
+  struct kernel_info before, after;
+  kinfoRead(&before);
+  Delay(5);
+  kinfoRead(&after);
+  CHECK(before.pid == pid && after.pid == pid);
+  CHECK(after.ticks - before.ticks >= 5);
+  CHECK(after.context_switches > before.context_switches);
+  CHECK(after.idle_ticks >= before.idle_ticks && after.idle_ticks <= after.ticks);
+  CHECK(after.seq != before.seq);
+
+  // a blocked child counts among the processes until it is reaped
+  kinfoRead(&before);
+  child = Fork();
+  if (child == 0)
+  {
+    Delay(5);
+    Exit(0);
+  }
+  // the count is refreshed on the next dispatch or tick
+  Delay(1);
+  kinfoRead(&after);
+  CHECK(after.processes == before.processes + 1);
+  CHECK(WaitPid(child, &status, 0, 0, NULL) == child && status == 0);
+  kinfoRead(&after);
+  CHECK(after.processes == before.processes);
+
+  TracePrintf(4, "testProcess: info page checks passed\n");
+  return 0;
+}
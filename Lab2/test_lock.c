@@ -0,0 +1,189 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+#define THREADS 4
+#define THREAD_STACK_SIZE (4 * PAGESIZE)
+// the increments of each thread, each one sleeps inside the lock
+#define INCREMENTS 5
+// the items the producer hands to the consumer through the condition variables
+#define ITEMS 100
+
+// shared by all the threads
+int lock, not_empty, not_full, go;
+int counter = 0;
+int order[THREADS];
+int ordered = 0;
+int item = -1;
+int waiting = 0;
+int started = 0;
+
+void *newStack()
+{
+  return (char *)malloc(THREAD_STACK_SIZE) + THREAD_STACK_SIZE;
+}
+
+// increment the counter, losing increments unless the lock keeps the others out
+void increment(void *arg)
+{
+  int i;
+  for (i = 0; i < INCREMENTS; i++)
+  {
+    CHECK(Acquire(lock) == 0);
+    int value = counter;
+    Delay(1);
+    counter = value + 1;
+    CHECK(Release(lock) == 0);
+  }
+  ThreadExit((int)arg);
+}
+
+// note when the thread got the lock
+void takeTurn(void *arg)
+{
+  CHECK(Acquire(lock) == 0);
+  order[ordered++] = (int)arg;
+  CHECK(Release(lock) == 0);
+  ThreadExit(0);
+}
+
+void produce(void *arg)
+{
+  int i;
+  for (i = 0; i < ITEMS; i++)
+  {
+    CHECK(Acquire(lock) == 0);
+    while (item != -1)
+      CHECK(CvarWait(not_full, lock) == 0);
+    item = i;
+    CHECK(CvarSignal(not_empty) == 0);
+    CHECK(Release(lock) == 0);
+  }
+  ThreadExit((int)arg);
+}
+
+// wait for the go of the broadcast
+void awaitGo(void *arg)
+{
+  CHECK(Acquire(lock) == 0);
+  waiting++;
+  while (!started)
+    CHECK(CvarWait(go, lock) == 0);
+  waiting--;
+  CHECK(Release(lock) == 0);
+  ThreadExit((int)arg);
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  CHECK(LockInit(&lock) == 0);
+  CHECK(CvarInit(&not_empty) == 0);
+  CHECK(CvarInit(&not_full) == 0);
+  CHECK(CvarInit(&go) == 0);
+
+  // the lock is not recursive and only its owner releases it
+  CHECK(Release(lock) == ERROR);
+  CHECK(Acquire(lock) == 0);
+  CHECK(Acquire(lock) == ERROR);
+  CHECK(CvarWait(not_empty, not_full) == ERROR);
+  CHECK(Release(lock) == 0);
+  CHECK(CvarWait(not_empty, lock) == ERROR);
+
+  // no increment is lost
+  int i, status;
+  int tids[THREADS];
+  for (i = 0; i < THREADS; i++)
+    tids[i] = ThreadCreate(increment, (void *)i, newStack());
+  for (i = 0; i < THREADS; i++)
+    CHECK(ThreadJoin(tids[i], &status) == 0 && status == i);
+  CHECK(counter == THREADS * INCREMENTS);
+
+  // the waiters get the lock in the order they came
+  CHECK(Acquire(lock) == 0);
+  for (i = 0; i < THREADS; i++)
+  {
+    tids[i] = ThreadCreate(takeTurn, (void *)i, newStack());
+    // let it block on the lock before the next one comes
+    Delay(1);
+  }
+  CHECK(Release(lock) == 0);
+  for (i = 0; i < THREADS; i++)
+    CHECK(ThreadJoin(tids[i], &status) == 0);
+  CHECK(ordered == THREADS);
+  for (i = 0; i < THREADS; i++)
+    CHECK(order[i] == i);
+
+  // every item arrives once and in order
+  int producer = ThreadCreate(produce, (void *)0, newStack());
+  int consumed = 0;
+  while (consumed < ITEMS)
+  {
+    CHECK(Acquire(lock) == 0);
+    while (item == -1)
+      CHECK(CvarWait(not_empty, lock) == 0);
+    CHECK(item == consumed);
+    item = -1;
+    consumed++;
+    CHECK(CvarSignal(not_full) == 0);
+    CHECK(Release(lock) == 0);
+  }
+  CHECK(ThreadJoin(producer, &status) == 0);
+
+  // a broadcast lets every waiter go, nothing waited on can be reclaimed meanwhile
+  for (i = 0; i < THREADS; i++)
+    tids[i] = ThreadCreate(awaitGo, (void *)i, newStack());
+  CHECK(Acquire(lock) == 0);
+  while (waiting < THREADS)
+  {
+    CHECK(Release(lock) == 0);
+    Delay(1);
+    CHECK(Acquire(lock) == 0);
+  }
+  CHECK(Reclaim(go) == ERROR);
+  CHECK(Release(lock) == 0);
+  CHECK(Reclaim(lock) == ERROR);
+  CHECK(Acquire(lock) == 0);
+  started = 1;
+  CHECK(CvarBroadcast(go) == 0);
+  CHECK(Reclaim(lock) == ERROR);
+  CHECK(Release(lock) == 0);
+  for (i = 0; i < THREADS; i++)
+    CHECK(ThreadJoin(tids[i], &status) == 0 && status == i);
+  CHECK(waiting == 0);
+
+  // a process that exits holding the lock hands it over
+  int pid = Fork();
+  if (pid == 0)
+  {
+    CHECK(Acquire(lock) == 0);
+    Exit(0);
+  }
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == 0);
+  CHECK(Acquire(lock) == 0);
+  CHECK(Release(lock) == 0);
+
+  // the next lock or condition variable in the same slot gets a new id, the old one stays dead
+  CHECK(Reclaim(lock) == 0);
+  CHECK(Reclaim(go) == 0);
+  CHECK(Reclaim(lock) == ERROR);
+  int new_lock, new_go;
+  CHECK(LockInit(&new_lock) == 0 && new_lock != lock);
+  CHECK(CvarInit(&new_go) == 0 && new_go != go);
+  CHECK(Acquire(lock) == ERROR);
+  CHECK(CvarSignal(go) == ERROR);
+  CHECK(Acquire(new_lock) == 0);
+  CHECK(Release(new_lock) == 0);
+
+  CHECK(Reclaim(new_lock) == 0);
+  CHECK(Reclaim(new_go) == 0);
+  CHECK(Reclaim(not_empty) == 0);
+  CHECK(Reclaim(not_full) == 0);
+  TracePrintf(4, "testProcess: lock checks passed\n");
+  return 0;
+}
@@ -0,0 +1,117 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+// more than the pipe holds, so the producer has to block
+#define STREAM_SIZE (3 * 4096 + 100)
+// the writes of each writer, which never get split
+#define RUN_SIZE 1000
+#define RUNS 2
+
+char buf[STREAM_SIZE];
+
+// write the bytes of the stream in uneven chunks, each byte is its position
+void producer(int pipe_id)
+{
+  char chunk[300];
+  int sent = 0;
+  while (sent < STREAM_SIZE)
+  {
+    int len = STREAM_SIZE - sent < (int)sizeof(chunk) ? STREAM_SIZE - sent : (int)sizeof(chunk);
+    int i;
+    for (i = 0; i < len; i++)
+      chunk[i] = (char)(sent + i);
+    CHECK(PipeWrite(pipe_id, chunk, len) == len);
+    sent += len;
+  }
+  Exit(0);
+}
+
+// write a few runs of the letter
+void writer(int pipe_id, char letter)
+{
+  char run[RUN_SIZE];
+  memset(run, letter, sizeof(run));
+  int i;
+  for (i = 0; i < RUNS; i++)
+    CHECK(PipeWrite(pipe_id, run, sizeof(run)) == RUN_SIZE);
+  Exit(0);
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int pipe_id, status, i;
+  CHECK(PipeInit(&pipe_id) == 0);
+
+  // the chars come out in order, a read takes what is there up to len
+  CHECK(PipeWrite(pipe_id, "hello", 5) == 5);
+  CHECK(PipeRead(pipe_id, buf, 3) == 3 && memcmp(buf, "hel", 3) == 0);
+  CHECK(PipeRead(pipe_id, buf, 10) == 2 && memcmp(buf, "lo", 2) == 0);
+
+  // a stream longer than the pipe arrives whole and in order
+  int pid = Fork();
+  if (pid == 0)
+    producer(pipe_id);
+  int received = 0;
+  while (received < STREAM_SIZE)
+  {
+    int len = PipeRead(pipe_id, buf + received, STREAM_SIZE - received);
+    CHECK(len > 0);
+    received += len;
+  }
+  for (i = 0; i < STREAM_SIZE; i++)
+    CHECK(buf[i] == (char)i);
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == 0);
+
+  // the writes of two writers are not interleaved
+  int writers[2];
+  writers[0] = Fork();
+  if (writers[0] == 0)
+    writer(pipe_id, 'a');
+  writers[1] = Fork();
+  if (writers[1] == 0)
+    writer(pipe_id, 'b');
+  int total = 2 * RUNS * RUN_SIZE;
+  received = 0;
+  while (received < total)
+    received += PipeRead(pipe_id, buf + received, total - received);
+  int run_start = 0;
+  for (i = 1; i <= total; i++)
+    if (i == total || buf[i] != buf[run_start])
+    {
+      CHECK((i - run_start) % RUN_SIZE == 0);
+      run_start = i;
+    }
+  for (i = 0; i < 2; i++)
+    CHECK(WaitPid(writers[i], &status, 0, 0, NULL) == writers[i] && status == 0);
+
+  // a writer blocked on a full pipe gets ERROR once the pipe is reclaimed
+  memset(buf, 'f', 4096);
+  CHECK(PipeWrite(pipe_id, buf, 4096) == 4096);
+  pid = Fork();
+  if (pid == 0)
+    Exit(PipeWrite(pipe_id, buf, 1) == ERROR ? 0 : 1);
+  Delay(1);
+  CHECK(Reclaim(pipe_id) == 0);
+  CHECK(WaitPid(pid, &status, 0, 0, NULL) == pid && status == 0);
+  CHECK(PipeRead(pipe_id, buf, 1) == ERROR);
+  CHECK(Reclaim(pipe_id) == ERROR);
+
+  // the next pipe in the same slot gets a new id, the old one stays dead
+  int new_pipe_id;
+  CHECK(PipeInit(&new_pipe_id) == 0);
+  CHECK(new_pipe_id != pipe_id);
+  CHECK(PipeWrite(pipe_id, "x", 1) == ERROR);
+  CHECK(PipeWrite(new_pipe_id, "x", 1) == 1);
+  CHECK(Reclaim(new_pipe_id) == 0);
+
+  TracePrintf(4, "testProcess: pipe checks passed\n");
+  return 0;
+}
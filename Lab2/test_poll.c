@@ -0,0 +1,52 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+#define ROUNDS 10
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  // one process serves terminals 1 to 3, echoing every line typed on any of them
+  struct poll_fd fds[NUM_TERMINALS - 1];
+  int i;
+  for (i = 0; i < NUM_TERMINALS - 1; i++)
+  {
+    fds[i].tty_id = i + 1;
+    fds[i].events = POLL_READ;
+    TtySetFlags(i + 1, TTY_NONBLOCK);
+  }
+
+  char buf[TERMINAL_MAX_LINE];
+  int round;
+  for (round = 0; round < ROUNDS; round++)
+  {
+    int ready = Poll(fds, NUM_TERMINALS - 1, 50);
+    TracePrintf(4, "testProcess: round %d, %d terminals ready\n", round, ready);
+    for (i = 0; i < NUM_TERMINALS - 1; i++)
+    {
+      if (!(fds[i].revents & POLL_READ))
+        continue;
+      int len = TtyRead(fds[i].tty_id, buf, sizeof(buf));
+      int written = TtyWrite(fds[i].tty_id, buf, len);
+      TracePrintf(4, "testProcess: terminal %d read %d, wrote %d\n", fds[i].tty_id, len, written);
+    }
+  }
+
+  // with nothing typed, a nonblocking read does not wait
+  TracePrintf(4, "testProcess: nonblocking read returned %d\n", TtyRead(1, buf, sizeof(buf)));
+
+  // a full transmit ring makes a nonblocking write return short, then TTY_WOULD_BLOCK
+  memset(buf, 'x', sizeof(buf));
+  for (i = 0; i < 3; i++)
+    TracePrintf(4, "testProcess: nonblocking write returned %d\n", TtyWrite(1, buf, sizeof(buf)));
+
+  struct poll_fd out = {1, POLL_WRITE, 0};
+  TracePrintf(4, "testProcess: poll for write returned %d with revents %d\n", Poll(&out, 1, -1), out.revents);
+  return 0;
+}
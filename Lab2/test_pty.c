@@ -0,0 +1,57 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+#define LINES 1000
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int master, slave;
+  if (PtyOpen(&master, &slave) == ERROR)
+  {
+    TracePrintf(4, "testProcess: PtyOpen failed\n");
+    return 1;
+  }
+  TracePrintf(4, "testProcess: opened the pair %d (master) and %d (slave)\n", master, slave);
+
+  char line[64];
+  int len;
+  if (Fork() == 0)
+  {
+    // an interactive program on the slave end: it echoes every line back in upper case
+    while ((len = TtyRead(slave, line, sizeof(line))) > 0)
+    {
+      int i;
+      for (i = 0; i < len; i++)
+        if (line[i] >= 'a' && line[i] <= 'z')
+          line[i] -= 'a' - 'A';
+      TtyWrite(slave, line, len);
+    }
+    TracePrintf(4, "testProcess: the slave end read %d, the master is closed\n", len);
+    PtyClose(slave);
+    Exit(0);
+  }
+
+  // the harness drives it from the master end, with no terminal rate limit in between
+  int i;
+  for (i = 0; i < LINES; i++)
+  {
+    sprintf(line, "line %d\n", i);
+    TtyWrite(master, line, strlen(line));
+    len = TtyRead(master, line, sizeof(line));
+    if (i % 100 == 0)
+      TracePrintf(4, "testProcess: the master end read back %d chars: %s", len, line);
+  }
+
+  PtyClose(master);
+  int status;
+  Wait(&status);
+  TracePrintf(4, "testProcess: %d lines went through the pair, TtyWrite to the closed end returned %d\n", LINES, TtyWrite(master, line, 1));
+  return 0;
+}
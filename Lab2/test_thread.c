@@ -0,0 +1,119 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+#define THREADS 4
+#define THREAD_STACK_SIZE (4 * PAGESIZE)
+
+// shared by all the threads, a forked child would only change its own copy
+int slots[THREADS];
+int forked_pid = 0;
+int waited_status = 0;
+
+// each thread fills its own slot, so the result does not depend on the order they run in
+void fillSlot(void *arg)
+{
+  int id = (int)arg;
+  Delay(1);
+  slots[id] = id * 100 + 1;
+  ThreadExit(id + 10);
+}
+
+void emptyThread(void *arg)
+{
+  ThreadExit((int)arg);
+}
+
+void sleepingThread(void *arg)
+{
+  Delay(100000);
+  ThreadExit((int)arg);
+}
+
+// a child forked by a thread belongs to the process, it is still there for the main thread after the thread ends
+void forkingThread(void *arg)
+{
+  int pid = Fork();
+  if (pid == 0)
+  {
+    Delay(2);
+    Exit(7);
+  }
+  forked_pid = pid;
+  ThreadExit((int)arg);
+}
+
+// and any thread can wait for a child of the process
+void waitingThread(void *arg)
+{
+  int status;
+  if (WaitPid((int)arg, &status, 0, 0, NULL) == (int)arg)
+    waited_status = status;
+  ThreadExit(0);
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int i, status;
+  char *stacks[THREADS];
+  int tids[THREADS];
+  for (i = 0; i < THREADS; i++)
+  {
+    stacks[i] = malloc(THREAD_STACK_SIZE);
+    tids[i] = ThreadCreate(fillSlot, (void *)i, stacks[i] + THREAD_STACK_SIZE);
+    CHECK(tids[i] > 0 && tids[i] != GetPid());
+  }
+  for (i = 0; i < THREADS; i++)
+  {
+    CHECK(ThreadJoin(tids[i], &status) == 0);
+    TracePrintf(4, "testProcess: joined thread %d with status %d\n", tids[i], status);
+    CHECK(status == i + 10);
+    CHECK(slots[i] == i * 100 + 1);
+  }
+
+  // a thread is joined once, the main thread never, and a thread is no child
+  CHECK(ThreadJoin(tids[0], &status) == ERROR);
+  CHECK(ThreadJoin(GetPid(), &status) == ERROR);
+  tids[0] = ThreadCreate(emptyThread, (void *)3, stacks[0] + THREAD_STACK_SIZE);
+  CHECK(WaitPid(tids[0], &status, WNOHANG, 0, NULL) == ERROR);
+
+  // exec must be rejected while another thread is alive
+  char *args[] = {"test_thread", NULL};
+  CHECK(Exec("test_thread", args) == ERROR);
+  CHECK(ThreadJoin(tids[0], &status) == 0 && status == 3);
+
+  // the child of a thread outlives the thread, and the main thread collects it
+  tids[0] = ThreadCreate(forkingThread, (void *)0, stacks[0] + THREAD_STACK_SIZE);
+  CHECK(ThreadJoin(tids[0], &status) == 0);
+  CHECK(forked_pid > 0);
+  CHECK(WaitPid(forked_pid, &status, 0, 0, NULL) == forked_pid && status == 7);
+
+  // the child of the main thread, collected by another thread
+  int pid = Fork();
+  if (pid == 0)
+    Exit(8);
+  tids[0] = ThreadCreate(waitingThread, (void *)pid, stacks[0] + THREAD_STACK_SIZE);
+  CHECK(ThreadJoin(tids[0], &status) == 0 && waited_status == 8);
+
+  // the main thread ends the process with the threads still sleeping in it
+  pid = Fork();
+  if (pid == 0)
+  {
+    for (i = 0; i < THREADS; i++)
+      ThreadCreate(sleepingThread, (void *)i, stacks[i] + THREAD_STACK_SIZE);
+    Delay(1);
+    Exit(5);
+  }
+  CHECK(WaitPid(pid, &status, 0, 20, NULL) == pid && status == 5);
+
+  for (i = 0; i < THREADS; i++)
+    free(stacks[i]);
+  TracePrintf(4, "testProcess: thread checks passed\n");
+  return 0;
+}
@@ -0,0 +1,54 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+// a write spanning several pages, too long for the transmit ring, so it goes out straight from our pages
+#define WRITE_SIZE (4 * PAGESIZE)
+#define WRITES 3
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  char *buf = malloc(WRITE_SIZE);
+  CHECK(buf != NULL);
+  int i;
+  for (i = 0; i < WRITE_SIZE; i++)
+    buf[i] = (i + 1) % 64 == 0 ? '\n' : '0' + i % 10;
+
+  // every long write returns once all of it is transmitted
+  for (i = 0; i < WRITES; i++)
+    CHECK(TtyWrite(1, buf, WRITE_SIZE) == WRITE_SIZE);
+  CHECK(TtyDrain(1) == 0);
+
+  // the buffer is checked before anything is written
+  CHECK(TtyWrite(1, NULL, 10) == ERROR);
+  CHECK(TtyWrite(1, buf, 0) == 0);
+
+  // a writer killed in the middle of a line, its pages must stay until the terminal is done with them
+  int status;
+  int writer = Fork();
+  if (writer == 0)
+  {
+    TtyWrite(1, buf, WRITE_SIZE);
+    Exit(0);
+  }
+  Delay(1);
+  CHECK(Kill(writer) == 0);
+  CHECK(WaitPid(writer, &status, 0, 0, NULL) == writer && status == EXIT_KILLED);
+
+  // and the terminal goes on for the next writer, who gets it to itself
+  char *msg = "the terminal is free again\n";
+  CHECK(TtyWrite(1, msg, strlen(msg)) == (int)strlen(msg));
+  CHECK(TtyWrite(1, buf, WRITE_SIZE) == WRITE_SIZE);
+  CHECK(TtyDrain(1) == 0);
+
+  free(buf);
+  TracePrintf(4, "testProcess: long write checks passed\n");
+  return 0;
+}
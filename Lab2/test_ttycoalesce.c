@@ -0,0 +1,40 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+#define WRITERS 8
+#define LINES 10
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int i, status;
+  for (i = 0; i < WRITERS; i++)
+  {
+    if (Fork() == 0)
+    {
+      // lots of short lines, they pile up behind the busy terminal and go out together
+      char line[32];
+      int j;
+      for (j = 0; j < LINES; j++)
+      {
+        sprintf(line, "writer %d line %d\n", i, j);
+        TtyWrite(TTY_CONSOLE, line, strlen(line));
+      }
+      Exit(0);
+    }
+  }
+
+  for (i = 0; i < WRITERS; i++)
+    Wait(&status);
+  TtyDrain(TTY_CONSOLE);
+
+  // the kernel traces the chars per transmit against the number of writes
+  TracePrintf(4, "testProcess: %d writes are on the console\n", WRITERS * LINES);
+  return 0;
+}
@@ -0,0 +1,35 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+#define LINES 20
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  char line[64];
+  int i;
+  volatile int work = 0;
+  // a chatty process, every write returns as soon as the line is in the ring
+  // so the computation below overlaps with the terminal output
+  for (i = 0; i < LINES; i++)
+  {
+    sprintf(line, "log line %d\n", i);
+    TtyWrite(1, line, strlen(line));
+    int j;
+    for (j = 0; j < 100000; j++)
+      work++;
+  }
+  TracePrintf(4, "testProcess: all %d lines are queued\n", LINES);
+
+  TtyDrain(1);
+  TracePrintf(4, "testProcess: all %d lines are on terminal 1\n", LINES);
+
+  TracePrintf(4, "testProcess: TtyDrain(%d) returned %d\n", NUM_TERMINALS, TtyDrain(NUM_TERMINALS));
+  return 0;
+}
@@ -0,0 +1,41 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  char buf[TERMINAL_MAX_LINE];
+  int len;
+
+  // canonical: type lines on terminal 1 with backspaces and ^U in them, ^D alone ends this part
+  while ((len = TtyRead(1, buf, sizeof(buf))) > 0)
+  {
+    TracePrintf(4, "testProcess: canonical read %d chars\n", len);
+    TtyWrite(2, buf, len);
+  }
+  TracePrintf(4, "testProcess: end of input on terminal 1\n");
+
+  // raw: every read waits for 8 chars, but no more than 20 ticks
+  TtySetMode(1, TTY_MODE_RAW, 8, 20);
+  int i;
+  for (i = 0; i < 5; i++)
+  {
+    len = TtyRead(1, buf, sizeof(buf));
+    TracePrintf(4, "testProcess: raw read %d chars\n", len);
+    TtyWrite(2, buf, len);
+  }
+
+  // raw with no min and no timeout never blocks
+  TtySetMode(1, TTY_MODE_RAW, 0, 0);
+  TracePrintf(4, "testProcess: polling read returned %d\n", TtyRead(1, buf, sizeof(buf)));
+
+  TracePrintf(4, "testProcess: TtySetMode with mode 7 returned %d\n", TtySetMode(1, 7, 0, 0));
+  TtySetMode(1, TTY_MODE_CANONICAL, 0, 0);
+  return 0;
+}
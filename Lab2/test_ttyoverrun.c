@@ -0,0 +1,35 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+
+#define IDLE_TICKS 30
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  // nobody reads terminal 1 for a while, type (or paste) more than the receive ring holds meanwhile
+  Delay(IDLE_TICKS);
+
+  struct tty_stats stats;
+  TtyGetStats(1, &stats);
+  TracePrintf(4, "testProcess: %d lines (%d chars) received, %d chars unread, %d overruns, %d lines (%d chars) dropped\n",
+              stats.received_lines, stats.received_bytes, stats.unread_bytes, stats.overruns, stats.dropped_lines, stats.dropped_bytes);
+
+  // the kernel heap stays the same however much was typed, and the lines kept are whole
+  char line[TERMINAL_MAX_LINE];
+  int len;
+  while (stats.unread_bytes > 0)
+  {
+    len = TtyRead(1, line, TERMINAL_MAX_LINE);
+    TtyWrite(2, line, len);
+    TtyGetStats(1, &stats);
+  }
+
+  TracePrintf(4, "testProcess: TtyGetStats(%d) returned %d\n", NUM_TERMINALS, TtyGetStats(NUM_TERMINALS, &stats));
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK 5
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  // type lines longer than CHUNK into terminal 1, each read returns at most CHUNK chars
+  // and the rest of the line comes with the next reads, up to its newline
+  char buf[CHUNK + 1];
+  int lines = 0;
+  while (lines < 3)
+  {
+    int len = TtyRead(1, buf, CHUNK);
+    buf[len] = '\0';
+    TracePrintf(4, "testProcess: read %d chars \"%s\"\n", len, buf);
+    TtyWrite(2, buf, len);
+    if (buf[len - 1] == '\n')
+      lines++;
+  }
+
+  return 0;
+}
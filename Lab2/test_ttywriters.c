@@ -0,0 +1,39 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WRITERS 4
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int i, status;
+  for (i = 0; i < WRITERS; i++)
+  {
+    if (Fork() == 0)
+    {
+      // several lines in a single write, they must come out together
+      int len = 3 * TERMINAL_MAX_LINE;
+      char *buf = malloc(len);
+      int j;
+      for (j = 0; j < len; j++)
+        buf[j] = (j + 1) % 40 == 0 ? '\n' : 'a' + i;
+      TtyWrite(TTY_CONSOLE, buf, len);
+      Exit(i);
+    }
+  }
+
+  // the other terminal is not held up by the console writers
+  char *msg = "terminal 1 is not waiting for the console\n";
+  TtyWrite(1, msg, strlen(msg));
+
+  for (i = 0; i < WRITERS; i++)
+    Wait(&status);
+
+  TracePrintf(4, "testProcess: TtyWrite to terminal %d returned %d\n", NUM_TERMINALS, TtyWrite(NUM_TERMINALS, msg, 1));
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+void printUsage(char *who, struct process_usage *usage)
+{
+  TracePrintf(4, "testProcess: %s ran %d, runnable %d, delay %d, wait %d, tty read %d, tty write %d ticks\n", who, usage->user_ticks, usage->runnable_ticks, usage->delay_ticks, usage->wait_ticks, usage->tty_read_ticks, usage->tty_write_ticks);
+  TracePrintf(4, "testProcess: %s switched %d voluntary and %d involuntary, %d page faults, %d brk pages, %d/%d tty bytes read/written\n", who, usage->voluntary_switches, usage->involuntary_switches, usage->page_faults, usage->brk_pages, usage->tty_read_bytes, usage->tty_write_bytes);
+}
+
+// grow the stack by a few pages, each one is a page fault
+int deepStack(int depth)
+{
+  char frame[PAGESIZE / 2];
+  memset(frame, depth, sizeof(frame));
+  return depth == 0 ? frame[0] : deepStack(depth - 1) + frame[1];
+}
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int i;
+  // a cpu bound competitor, so the children below spend some time runnable
+  int spinner = Fork();
+  if (spinner == 0)
+  {
+    while (1)
+      ;
+  }
+
+  int child = Fork();
+  if (child == 0)
+  {
+    volatile int x = 0;
+    for (i = 0; i < 3000000; i++)
+      x++;
+    Delay(3);
+    char *msg = "usage test writing to the terminal\n";
+    TtyWrite(TTY_CONSOLE, msg, strlen(msg));
+    free(malloc(8 * PAGESIZE));
+    deepStack(8);
+    Exit(0);
+  }
+
+  struct process_usage so_far, usage;
+  Delay(1);
+  CHECK(GetUsage(child, &so_far) == 0);
+  printUsage("child so far", &so_far);
+
+  int status;
+  CHECK(WaitPid(child, &status, 0, 0, &usage) == child && status == 0);
+  printUsage("child", &usage);
+  // the counters only go up, and by now the child has slept, grown its stack and its heap
+  CHECK(usage.user_ticks >= so_far.user_ticks && usage.runnable_ticks >= so_far.runnable_ticks);
+  CHECK(usage.delay_ticks >= so_far.delay_ticks && usage.delay_ticks >= 3);
+  CHECK(usage.voluntary_switches >= so_far.voluntary_switches && usage.voluntary_switches > 0);
+  CHECK(usage.involuntary_switches >= so_far.involuntary_switches);
+  CHECK(usage.page_faults >= so_far.page_faults && usage.page_faults > 0);
+  CHECK(usage.brk_pages >= 8);
+  CHECK(usage.tty_write_bytes == (int)strlen("usage test writing to the terminal\n"));
+  CHECK(usage.tty_read_bytes == 0);
+
+  CHECK(Kill(spinner) == 0);
+  CHECK(WaitPid(spinner, &status, 0, 0, &usage) == spinner && status == EXIT_KILLED);
+  printUsage("spinner", &usage);
+  CHECK(usage.user_ticks > 0 && usage.involuntary_switches > 0 && usage.voluntary_switches == 0);
+
+  // the parent waited for the child and slept in Delay
+  CHECK(GetUsage(0, &usage) == 0);
+  printUsage("parent", &usage);
+  CHECK(usage.wait_ticks > 0 && usage.delay_ticks >= 1);
+
+  // the usage of a child goes away with its exit status
+  CHECK(GetUsage(child, &usage) == ERROR);
+
+  TracePrintf(4, "testProcess: GetUsage checks passed\n");
+  return 0;
+}
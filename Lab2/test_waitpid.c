@@ -0,0 +1,64 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <comp421/loadinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_call.h"
+#include "test_check.h"
+
+int main(int argc, char **argv)
+{
+  TracePrintf(4, "testProcess: test process is running with %d args at position %p\n", argc, argv);
+
+  int status;
+  int slow = Fork();
+  if (slow == 0)
+  {
+    Delay(10);
+    Exit(1);
+  }
+
+  int fast = Fork();
+  if (fast == 0)
+  {
+    Delay(2);
+    Exit(2);
+  }
+
+  // nobody has exited yet
+  int pid = WaitPid(slow, &status, WNOHANG, 0, NULL);
+  TracePrintf(4, "testProcess: WNOHANG returned %d\n", pid);
+  CHECK(pid == 0);
+
+  // the slow child can not make it in 3 ticks
+  pid = WaitPid(slow, &status, 0, 3, NULL);
+  TracePrintf(4, "testProcess: timed wait returned %d\n", pid);
+  CHECK(pid == 0);
+
+  // the fast child has exited by now, but we only want the slow one
+  pid = WaitPid(slow, &status, 0, 0, NULL);
+  TracePrintf(4, "testProcess: child %d is done with status %d\n", pid, status);
+  CHECK(pid == slow && status == 1);
+
+  // the fast one is still there for any child
+  pid = WaitPid(-1, &status, 0, 0, NULL);
+  TracePrintf(4, "testProcess: child %d is done with status %d\n", pid, status);
+  CHECK(pid == fast && status == 2);
+
+  // no children left, and a pid that is not our child is never waited for
+  pid = WaitPid(-1, &status, 0, 0, NULL);
+  TracePrintf(4, "testProcess: wait without children returned %d\n", pid);
+  CHECK(pid == ERROR);
+  CHECK(WaitPid(fast, &status, WNOHANG, 0, NULL) == ERROR);
+  CHECK(WaitPid(GetPid(), &status, 0, 0, NULL) == ERROR);
+
+  // an invalid status pointer is refused
+  int child = Fork();
+  if (child == 0)
+    Exit(3);
+  CHECK(WaitPid(child, NULL, 0, 0, NULL) == ERROR);
+  CHECK(WaitPid(child, &status, 0, 0, NULL) == child && status == 3);
+
+  TracePrintf(4, "testProcess: WaitPid checks passed\n");
+  return 0;
+}
@@ -3,17 +3,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "handler.h"
-#include "pcb.h"
-#include "switch.h"
-#include "page.h"
-#include "pte.h"
-#include "load.h"
-#include "exit_status.h"
 #include "tty_buffer.h"
 
-tty_buf *createBuffer() 
+tty_buf *createBuffer(int capacity, int index_lines) 
 {
+    // the index arithmetic masks with capacity - 1
+    if (capacity <= 0 || (capacity & (capacity - 1)) != 0)
+    {
+        TracePrintf(0, "createBuffer: capacity %d is not a power of two\n", capacity);
+        return NULL;
+    }
+
     tty_buf *buf = (tty_buf *)malloc(sizeof(tty_buf));
 
     if (buf == NULL) 
@@ -23,18 +23,34 @@ tty_buf *createBuffer()
     }
 
     // allocate memory from region 1 to create the array for the chars
-    buf->items = (char *)malloc(INITIAL_CAPACITY * sizeof(char));
+    buf->items = (char *)malloc(capacity * sizeof(char));
     if (buf->items == NULL) 
     {
         free(buf);
         return NULL;
     }
 
+    // a ring of capacity chars holds at most capacity newlines
+    buf->newlines = NULL;
+    if (index_lines)
+    {
+        buf->newlines = (int *)malloc(capacity * sizeof(int));
+        if (buf->newlines == NULL)
+        {
+            free(buf->items);
+            free(buf);
+            return NULL;
+        }
+    }
+
     // initialize the variables
+    buf->newline_front = 0;
+    buf->newline_count = 0;
+    buf->eol = 0;
     buf->front = 0;
     buf->rear = 0;
     buf->size = 0;
-    buf->capacity = INITIAL_CAPACITY;
+    buf->capacity = capacity;
 
     return buf;
 }
@@ -49,6 +65,84 @@ int isEmpty(tty_buf *buf)
     return buf->size == 0;
 }
 
+int freeSpace(tty_buf *buf)
+{
+    return buf->capacity - buf->size;
+}
+
+// record the newlines among the len chars just added at position from
+static void indexNewlines(tty_buf *buf, int from, int len)
+{
+    int mask = buf->capacity - 1;
+    while (len > 0)
+    {
+        // look at one contiguous segment at a time
+        int seg_len = buf->capacity - from < len ? buf->capacity - from : len;
+        char *seg = buf->items + from;
+        char *newline = memchr(seg, '\n', seg_len);
+        if (buf->eol != 0)
+        {
+            char *eol = memchr(seg, buf->eol, newline == NULL ? seg_len : newline - seg);
+            if (eol != NULL)
+                newline = eol;
+        }
+        if (newline == NULL)
+        {
+            from = (from + seg_len) & mask;
+            len -= seg_len;
+            continue;
+        }
+
+        int position = newline - buf->items;
+        buf->newlines[(buf->newline_front + buf->newline_count) & mask] = position;
+        buf->newline_count++;
+        len -= position + 1 - from;
+        from = (position + 1) & mask;
+    }
+}
+
+// forget the newlines among the first len chars, before they are deleted
+static void forgetNewlines(tty_buf *buf, int len)
+{
+    int mask = buf->capacity - 1;
+    while (buf->newline_count > 0 && ((buf->newlines[buf->newline_front] - buf->front) & mask) < len)
+    {
+        buf->newline_front = (buf->newline_front + 1) & mask;
+        buf->newline_count--;
+    }
+}
+
+int getLineLength(tty_buf *buf)
+{
+    int mask = buf->capacity - 1;
+    if (buf->newlines != NULL)
+    {
+        if (buf->newline_count == 0)
+            return buf->size;
+        return ((buf->newlines[buf->newline_front] - buf->front) & mask) + 1;
+    }
+
+    int len = 0;
+    while (len < buf->size)
+    {
+        char c = buf->items[(buf->front + len) & mask];
+        if (c == '\n' || (c == buf->eol && c != 0))
+            return len + 1;
+        len++;
+    }
+    return len;
+}
+
+void dropBuf(tty_buf *buf, int len)
+{
+    if (len > buf->size)
+        len = buf->size;
+    if (buf->newlines != NULL)
+        forgetNewlines(buf, len);
+    buf->front = (buf->front + len) & (buf->capacity - 1);
+    buf->size -= len;
+}
+
 // void insert(tty_buf *buf, char item) 
 // {
 //     // ensure the buf is not full, if it is, grow it
@@ -72,29 +166,51 @@ int isEmpty(tty_buf *buf)
 //     return item;
 // }
 
+void *reserveBuf(tty_buf *buf, int len)
+{
+    // an empty ring starts over at the beginning, where there is the most contiguous room
+    if (isEmpty(buf))
+    {
+        buf->front = 0;
+        buf->rear = 0;
+    }
+
+    // the space must not wrap around, nor run into the chars not read yet
+    if (len > freeSpace(buf) || len > buf->capacity - buf->rear)
+        return NULL;
+    return buf->items + buf->rear;
+}
+
+void commitBuf(tty_buf *buf, int len)
+{
+    int from = buf->rear;
+    buf->rear = (buf->rear + len) & (buf->capacity - 1);
+    buf->size += len;
+    if (buf->newlines != NULL)
+        indexNewlines(buf, from, len);
+}
+
 int addBuf(tty_buf *target_buf, void *buf, int len) {
     char *charBuf = (char *)buf;
 
-    // check if growing is needed
-    while (target_buf->size + len > target_buf->capacity) 
+    // the ring never grows, the caller decides what to do with the rest
+    if (len > freeSpace(target_buf))
     {
-        growBuffer(target_buf);
+        len = freeSpace(target_buf);
     }
 
     if (target_buf->rear + len <= target_buf->capacity) 
     {
         memcpy(target_buf->items + target_buf->rear, charBuf, len);
-        target_buf->rear = (target_buf->rear + len) % target_buf->capacity;
     } else 
     {
         int first_seg_len = target_buf->capacity - target_buf->rear;
         memcpy(target_buf->items + target_buf->rear, charBuf, first_seg_len);
         charBuf += first_seg_len;
         memcpy(target_buf->items, charBuf, len - first_seg_len);
-        target_buf->rear = len - first_seg_len;
     }
 
-    target_buf->size += len;
+    commitBuf(target_buf, len);
     return len;
 }
 
@@ -111,15 +227,10 @@ int getBuf(tty_buf *target_buf, void *buf, int len, int get_line) {
     if (get_line) 
     // if we want to read to the next newline
     {
-        int cursor = target_buf->front;
-        to_read = 0;
-        // find the next newline
-        while (target_buf->items[cursor] != '\n') 
-        {
-            to_read++;
-            cursor = (cursor + 1) % target_buf->capacity;
-        }
-        to_read++; // including the newline itself
+        // including the newline itself, unless the line is longer than the caller can take
+        to_read = getLineLength(target_buf);
+        if (to_read > len)
+            to_read = len;
     } 
     else if (len > target_buf->size) 
     {
@@ -139,7 +250,9 @@ int getBuf(tty_buf *target_buf, void *buf, int len, int get_line) {
         memcpy(charBuf + first_seg_len, target_buf->items, to_read - first_seg_len);
     }
 
-    target_buf->front = (target_buf->front + to_read) % target_buf->capacity;
+    if (target_buf->newlines != NULL)
+        forgetNewlines(target_buf, to_read);
+    target_buf->front = (target_buf->front + to_read) & (target_buf->capacity - 1);
     target_buf->size -= to_read;
 
     return to_read;
@@ -151,30 +264,7 @@ void freeBuffer(tty_buf *buf)
     if (buf) 
     {
         free(buf->items);
+        free(buf->newlines);
         free(buf);
     }
 }
-
-void growBuffer(tty_buf *buf) 
-{
-    int new_capacity = buf->capacity * GROWTH_FACTOR;
-    char *new_items = realloc(buf->items, new_capacity * sizeof(char));
-    if (new_items == NULL) 
-    {
-        TracePrintf(0, "grow buffer failed\n");
-        return;
-    }
-
-    if (buf->front > buf->rear) 
-    {
-        // if the data in tty buffer is segmented, rearrange it to make it consistence with the logic
-        // that is to put the second segmentation (0, rear) at the end of the first one (front, capacity)
-        memcpy(new_items + buf->capacity, new_items, buf->rear * sizeof(char));
-        buf->rear += buf->capacity;
-    }
-
-    buf->items = new_items;
-    buf->capacity = new_capacity;
-}
-
-
@@ -4,28 +4,53 @@
 #include <comp421/yalnix.h>
 // this file stores the tty buffer functions
 
-#define INITIAL_CAPACITY 4
-#define GROWTH_FACTOR 2
-
 typedef struct {
     char *items;
     int front;
     int rear;
     int size;
     int capacity;
+    // the positions of the '\n' (and eol) chars in the ring, oldest first, kept only if the ring is created with index_lines
+    int *newlines;
+    int newline_front;
+    int newline_count;
+    // another char that ends a line like '\n' when it is added, 0 if none
+    char eol;
 } tty_buf;
 
-tty_buf* createBuffer();
+// create a ring of capacity chars, which must be a power of two
+// the ring is allocated once and never grows, so it is safe to fill from an interrupt handler
+// with index_lines, addBuf records where every line ends, so the line reads do not scan the ring
+tty_buf* createBuffer(int capacity, int index_lines);
+
+// the number of chars that can still be added to the ring
+int freeSpace(tty_buf *buf);
+
+// the number of chars up to and including the first '\n' (or eol) of the ring, or all of them if there is no newline
+// constant time for a ring with index_lines
+int getLineLength(tty_buf *buf);
+
+// delete the first len chars of the ring without copying them
+void dropBuf(tty_buf *buf, int len);
 
 int isFull(tty_buf *buf);
 
 int isEmpty(tty_buf *buf);
 
 // get a set of chars from the target tty buf and store them in buf and delete these chars from the buff
-// if get_line is set, this function will read the chars until the next '\n'
+// if get_line is set, this function will read the chars until the next '\n', but never more than len
+// the rest of a longer line stays in the ring for the next read
 int getBuf(tty_buf *target_buf, void *buf, int len, int get_line);
 
-// add a buf of length len to the target tty buf
+// get len contiguous free chars at the end of the ring, so a device can write into the ring itself
+// return NULL if the free space is shorter or wraps around, nothing is added until commitBuf
+void *reserveBuf(tty_buf *buf, int len);
+
+// add the len chars written into the space from reserveBuf to the ring
+void commitBuf(tty_buf *buf, int len);
+
+// add a buf of length len to the target tty buf, as much of it as fits
+// return the number of chars added
 int addBuf(tty_buf *target_buf, void *buf, int len);
 
 // // insert a char to the tty_buf
@@ -37,7 +62,4 @@ int addBuf(tty_buf *target_buf, void *buf, int len);
 // free the tty buffer
 void freeBuffer(tty_buf *buf);
 
-// dynamically grow the size of the buffer
-void growBuffer(tty_buf *buf);
-
 #endif // YALNIX_TTY_BUFFER_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef YALNIX_UMUTEX_H
+#define YALNIX_UMUTEX_H
+#include "kernel_call.h"
+// this file is a mutex for the threads of a user program, built on FutexWait and FutexWake
+// a free mutex is taken and given back with one atomic instruction, the kernel is called only when threads have to wait
+// include it in the user program, there is no library to link
+
+// the states of the word of a mutex
+#define UMUTEX_FREE 0
+#define UMUTEX_LOCKED 1
+#define UMUTEX_CONTENDED 2 // locked, and somebody may be waiting in the kernel
+
+typedef struct umutex
+{
+  int word;
+} umutex;
+
+#define UMUTEX_INITIALIZER {UMUTEX_FREE}
+
+static inline void umutexInit(umutex *mutex)
+{
+  mutex->word = UMUTEX_FREE;
+}
+
+// return 1 if the mutex is taken, 0 if it is held by somebody else
+static inline int umutexTryLock(umutex *mutex)
+{
+  return __sync_val_compare_and_swap(&mutex->word, UMUTEX_FREE, UMUTEX_LOCKED) == UMUTEX_FREE;
+}
+
+static inline void umutexLock(umutex *mutex)
+{
+  int state = __sync_val_compare_and_swap(&mutex->word, UMUTEX_FREE, UMUTEX_LOCKED);
+  if (state == UMUTEX_FREE)
+    return;
+  // mark it contended before sleeping so the holder knows to wake us
+  // whoever takes it from here on keeps it contended, since we cannot tell if others are still waiting
+  if (state != UMUTEX_CONTENDED)
+    state = __sync_lock_test_and_set(&mutex->word, UMUTEX_CONTENDED);
+  while (state != UMUTEX_FREE)
+  {
+    FutexWait(&mutex->word, UMUTEX_CONTENDED, 0);
+    state = __sync_lock_test_and_set(&mutex->word, UMUTEX_CONTENDED);
+  }
+}
+
+static inline void umutexUnlock(umutex *mutex)
+{
+  // nobody waits unless the word was contended
+  if (__sync_fetch_and_sub(&mutex->word, 1) != UMUTEX_LOCKED)
+  {
+    mutex->word = UMUTEX_FREE;
+    FutexWake(&mutex->word, 1);
+  }
+}
+
+#endif // YALNIX_UMUTEX_H
@@ -0,0 +1,131 @@
+#include <comp421/hardware.h>
+#include <comp421/yalnix.h>
+#include <stdlib.h>
+#include "wait_queue.h"
+#include "pcb.h"
+#include "switch.h"
+
+void initWaitQueue(struct wait_queue *queue, int reason, int sorted)
+{
+  queue->head.pcb = NULL;
+  queue->head.queue = queue;
+  queue->head.next = &queue->head;
+  queue->head.prev = &queue->head;
+  queue->reason = reason;
+  queue->sorted = sorted;
+}
+
+int isWaitQueueEmpty(struct wait_queue *queue)
+{
+  return queue->head.next == &queue->head;
+}
+
+struct pcb *peekWaitQueue(struct wait_queue *queue)
+{
+  return queue->head.next->pcb;
+}
+
+// link the entry at the end of the queue, or at its place by wake_tick if the queue is sorted
+static void enqueue(struct wait_queue *queue, struct wait_entry *entry)
+{
+  struct wait_entry *last = queue->head.prev;
+  if (queue->sorted)
+  {
+    // walk back from the tail, the sleepers with the same wake_tick stay in order
+    while (last != &queue->head && last->pcb->wake_tick > entry->pcb->wake_tick)
+      last = last->prev;
+  }
+  entry->queue = queue;
+  entry->prev = last;
+  entry->next = last->next;
+  last->next->prev = entry;
+  last->next = entry;
+}
+
+struct wait_queue *sleepOn(struct wait_queue *queue)
+{
+  return sleepOnMany(&queue, 1);
+}
+
+struct wait_queue *sleepOnMany(struct wait_queue **queues, int count)
+{
+  return sleepOnAndRun(queues, count, getNextProcess(0));
+}
+
+struct wait_queue *sleepOnAndRun(struct wait_queue **queues, int count, struct pcb *next_process)
+{
+  struct pcb *current_process = getCurrentProcess();
+
+  // sleeping on only some of the queues could miss the wakeup, so do not sleep at all
+  if (count > MAX_WAIT_QUEUES)
+  {
+    TracePrintf(0, "sleepOnMany: process %d can not sleep on %d queues\n", current_process->pid, count);
+    return NULL;
+  }
+
+  int i;
+  for (i = 0; i < count; i++)
+  {
+    current_process->waits[i].pcb = current_process;
+    enqueue(queues[i], &current_process->waits[i]);
+  }
+  current_process->wait_count = count;
+  current_process->wait_reason = queues[0]->reason;
+  current_process->woken_by = NULL;
+
+  TracePrintf(3, "sleepOnMany: process %d sleeps on %d queues, switching to process %d\n", current_process->pid, count, next_process->pid);
+  removeProcessFromList(current_process);
+  addProcessToList(current_process, BLOCKED_LIST);
+  switchProcess(current_process, next_process);
+
+  return current_process->woken_by;
+}
+
+struct pcb *wakeOne(struct wait_queue *queue)
+{
+  struct pcb *pcb = peekWaitQueue(queue);
+  if (pcb != NULL)
+    wakeProcess(pcb, queue);
+  return pcb;
+}
+
+int wakeAll(struct wait_queue *queue)
+{
+  int count = 0;
+  while (wakeOne(queue) != NULL)
+    count++;
+  return count;
+}
+
+struct pcb *requeueOne(struct wait_queue *queue, struct wait_queue *target)
+{
+  struct wait_entry *entry = queue->head.next;
+  if (entry == &queue->head)
+    return NULL;
+
+  entry->prev->next = entry->next;
+  entry->next->prev = entry->prev;
+  enqueue(target, entry);
+  return entry->pcb;
+}
+
+void wakeProcess(struct pcb *pcb, struct wait_queue *queue)
+{
+  TracePrintf(3, "wakeProcess: process %d is woken up\n", pcb->pid);
+  leaveWaitQueues(pcb);
+  pcb->woken_by = queue;
+  removeProcessFromList(pcb);
+  addProcessToList(pcb, EXECUTION_LIST);
+}
+
+void leaveWaitQueues(struct pcb *pcb)
+{
+  int i;
+  for (i = 0; i < pcb->wait_count; i++)
+  {
+    struct wait_entry *entry = &pcb->waits[i];
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+  }
+  pcb->wait_count = 0;
+}
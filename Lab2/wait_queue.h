@@ -0,0 +1,68 @@
+#ifndef YALNIX_WAIT_QUEUE_H
+#define YALNIX_WAIT_QUEUE_H
+// this file manages the wait queues
+// a blocked process sleeps on the queue of what it waits for (a timer, a terminal, its children ...)
+// so a waker only wakes up the processes of that queue, without scanning the others
+// a process may sleep on several queues at once and the first one to wake it up wins
+
+struct pcb;
+struct wait_queue;
+
+// the most queues a process can sleep on at the same time
+#define MAX_WAIT_QUEUES 8
+
+// the link of a sleeping process in a queue, every process has one for each queue it sleeps on
+typedef struct wait_entry
+{
+  struct pcb *pcb;
+  struct wait_queue *queue;
+  struct wait_entry *next;
+  struct wait_entry *prev;
+} wait_entry;
+
+typedef struct wait_queue
+{
+  struct wait_entry head; // the sentinel of the cyclic list of sleepers
+  int reason;             // what the sleepers are blocked on for the usage accounting (enum UsageState)
+  int sorted;             // 1 if the sleepers are kept sorted by wake_tick, like the timer queue
+} wait_queue;
+
+// initialize an empty queue
+void initWaitQueue(struct wait_queue *queue, int reason, int sorted);
+
+// is nobody sleeping on the queue
+int isWaitQueueEmpty(struct wait_queue *queue);
+
+// get the first sleeper of the queue without waking it up, NULL if the queue is empty
+struct pcb *peekWaitQueue(struct wait_queue *queue);
+
+// block the current process on the queue until it is woken up
+// return the queue that woke it up
+struct wait_queue *sleepOn(struct wait_queue *queue);
+
+// block the current process on all the queues until one of them wakes it up
+// the usage accounting charges the blocked ticks to the reason of the first queue
+// return the queue that woke it up, or NULL without blocking if there are more than MAX_WAIT_QUEUES
+struct wait_queue *sleepOnMany(struct wait_queue **queues, int count);
+
+// the same as sleepOnMany, but switch to next_process instead of the next one in line
+// next_process must be runnable, it is the process that the current one has just woken up to work for it
+struct wait_queue *sleepOnAndRun(struct wait_queue **queues, int count, struct pcb *next_process);
+
+// wake up the first sleeper of the queue, return it or NULL if the queue is empty
+struct pcb *wakeOne(struct wait_queue *queue);
+
+// wake up every sleeper of the queue, return how many are woken up
+int wakeAll(struct wait_queue *queue);
+
+// move the first sleeper of the queue to the end of another one without waking it up
+// it must sleep on this queue only, return it or NULL if the queue is empty
+struct pcb *requeueOne(struct wait_queue *queue, struct wait_queue *target);
+
+// wake up the sleeping process on behalf of the queue, it leaves all the queues it sleeps on
+void wakeProcess(struct pcb *pcb, struct wait_queue *queue);
+
+// take the process off all the queues it sleeps on without waking it up, used when it is killed
+void leaveWaitQueues(struct pcb *pcb);
+
+#endif // YALNIX_WAIT_QUEUE_H
@@ -12,6 +12,13 @@
 #include "handler.h"
 #include "exit_status.h"
 #include "terminal.h"
+#include "pty.h"
+#include "pipe.h"
+#include "ipc.h"
+#include "sync.h"
+#include "futex.h"
+#include "info_page.h"
+#include "container.h"
 
 /**
  * rule for level of trace:
@@ -23,8 +30,8 @@
  * after 5: more detailed trace information (inside double loop, etc.)
  */
 
-// the top few pages are used for the page table
-#define KERNEL_HEAP_LIMIT (uintptr_t) PAGE_TABLE_HELPER_2_VADDR
+// the top few pages are used for the page table, the terminal windows and the info page window
+#define KERNEL_HEAP_LIMIT (uintptr_t) KERNEL_INFO_WINDOW_VADDR
 
 // the kernel break
 static uintptr_t kernel_brk;
@@ -128,11 +135,19 @@ KernelStart(ExceptionInfo *info, unsigned int pmem_size, void *orig_brk, char **
 
   // STEP: initialize terminals
   initTerminals();
+  initPtys();
+  initPipes();
+  initIpc();
+  initSync();
+  initFutexes();
+  initInfoPage();
 
   // printPageTableEntries(page_table_1);
 
   // STEP 2: initialize the idle and init process
   initProcessManager();
+  initTimers();
+  initContainers();
 
   // first create idle process to have pid 0
   struct pcb *idle_process = createProcess();
@@ -140,53 +155,61 @@ KernelStart(ExceptionInfo *info, unsigned int pmem_size, void *orig_brk, char **
   struct pcb *init_process = createProcess();
 
   setIdleProcess(idle_process);
-  setCurrentProcess(idle_process);
-
-  // save current context to the idle process
-  idle_process->page_table = (uintptr_t)page_table_0;
-  TracePrintf(3, "KernelStart: idle process page table is %p, pid is %d\n", idle_process->page_table, idle_process->pid);
 
-  // we first load the idle process
+  // the idle process takes over the region 0 page table we have just built
+  // it runs the idle program in user mode, so the hardware can deliver interrupts while it pauses
+  createAddressSpace(idle_process, (uintptr_t)page_table_0);
+  mapInfoPage(PAGE_TABLE_0_VADDR);
+  setCurrentProcess(idle_process);
   char *idle_argv[] = {NULL};
-  LoadProgram("idle", idle_argv);
-  // printPageTableEntries(PAGE_TABLE_0_VADDR);
+  if (LoadProgram("idle", idle_argv) != 0)
+  {
+    TracePrintf(0, "KernelStart: failed to load the idle process\n");
+    Halt();
+  }
+  TracePrintf(3, "KernelStart: idle process page table is %p, pid is %d\n", idle_process->space->page_table, idle_process->pid);
 
-  // init_process->page_table = allocateHalfPage();
-  init_process->page_table = allocatePage();
-  TracePrintf(3, "KernelStart: idle process page table is %p, pid is %d\n", idle_process->page_table, idle_process->pid);
-  TracePrintf(3, "KernelStart: int process page table is %p, pid is %d\n", init_process->page_table, init_process->pid);
-  // then we context switch to the init process and load the init process
+  // the init process starts as a copy of the idle process, then loads its own program
+  if (getFramesLeft() < countPageTableEntries() + 1)
+  {
+    TracePrintf(0, "KernelStart: not enough pages to create the init process\n");
+    Halt();
+  }
+  uintptr_t init_page_table = allocatePage();
+  struct address_space *init_space = createAddressSpace(init_process, init_page_table);
+  init_space->brk = idle_process->space->brk;
+  init_space->stk = idle_process->space->stk;
+  init_process->pgid = init_process->pid;
+  joinContainer(init_process, getContainer(ROOT_CONTAINER));
+  TracePrintf(3, "KernelStart: int process page table is %p, pid is %d\n", init_space->page_table, init_process->pid);
   ContextSwitch(ForkSwitch, &idle_process->ctx, idle_process, init_process);
 
-  // because idle process's context is save to here
-  // we need to be causeful about which process we are in
-  // we will use pid to do the check
-  if (getCurrentProcess()->pid == INIT_PROCESS)
+  // because the idle process's context is saved here
+  // we need to be careful about which process we are in
+  if (getCurrentProcess() != init_process)
+  {
+    // the scheduler has switched to the idle process, back to its pause loop
+    info->sp = idle_process->sp;
+    info->pc = idle_process->pc;
+    return;
+  }
+
+  char *init_process_name = cmd_args[0];
+  char **init_argv = cmd_args + 1;
+  if (LoadProgram(init_process_name, init_argv) != 0)
   {
-    // this means we are inside of init process
-    // we will load the init process
-    char *init_process_name = cmd_args[0];
-    char **init_argv = cmd_args + 1;
-    LoadProgram(init_process_name, init_argv);
+    TracePrintf(0, "KernelStart: failed to load the init process\n");
+    Halt();
+  }
 
-    // printPageTableEntries(PAGE_TABLE_0_VADDR);
+  // printPageTableEntries(PAGE_TABLE_0_VADDR);
 
-    info->sp = init_process->sp;
-    info->pc = init_process->pc;
+  info->sp = init_process->sp;
+  info->pc = init_process->pc;
 
-    addProcessToList(init_process, EXECUTION_LIST);
+  addProcessToList(init_process, EXECUTION_LIST);
 
-    // use this context switch to test switch back to idle
-    // ContextSwitch(NormalSwitch, &init_process->ctx, init_process, idle_process);
-    TracePrintf(1, "KernelStart: kernel start finished:)\n");
-  }
-  else
-  {
-    // this means we are inside of idle process
-    // because we've already loaded the idle process, we don't need to do anything
-    info->sp = idle_process->sp;
-    info->pc = idle_process->pc;
-  }
+  TracePrintf(1, "KernelStart: kernel start finished:)\n");
 }
 
 extern int SetKernelBrk(void *addr)
@@ -218,7 +241,8 @@ extern int SetKernelBrk(void *addr)
     TracePrintf(3, "SetKernelBrk: we need to add %d pages\n", page_count);
     // if we failed in the middle, we will free all the pages we have added
     uintptr_t new_pages[page_count];
-    if (allocateMultiPage(page_count, new_pages) == -1)
+    // the kernel heap is not charged to the process that happens to be running
+    if (allocateKernelMultiPage(page_count, new_pages) == -1)
     {
       TracePrintf(0, "SetKernelBrk: failed to allocate pages\n");
       return -1;